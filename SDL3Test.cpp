@@ -6,6 +6,43 @@
 //  - Link against SDL3.lib.
 //  - Copy SDL3.dll into your Debug folder.
 //  - Paste this file into Source Files → main.cpp, then build & run.
+//
+// Build on Linux: see CMakeLists.txt (targets aimtrainer and
+// aimtrainer_bench, the benchmark suite with a JSON report).
+//
+// Command line:
+//  --bench-headless [N]    simulate N sessions per mode without a window
+//  --bench-projection [N]  time the projection paths over N targets
+//  --bench-swarm [N]       time N swarm clicks at 9..10000 targets
+//  --bench-tracking [N]    check N tracking sessions score the same at
+//                          30, 144 and 1000 ticks/s, and score aim changes
+//                          inside a motion step exactly
+//  --bench-motion [N]      tracking motion step and hit test cost, N targets
+//  --bench-scores [N]      score log append/reopen/lookup with N sessions
+//  --bench-config [MB]     config load time with an MB-sized score history
+//  --bench-stats [N]       analytics update and stats screen open with N sessions
+//  --bench-governor [N]    resolution governor on a synthetic load for N frames
+//  --bench-scenarios [N]   compile, cached reload and switch cost of N drill files
+//  --bench-player [N] [SKILL]  expected score distribution per drill
+//                          and skill over N simulated-player sessions
+//  --bench-suite [...]     the aimtrainer_bench suite, JSON report on stdout;
+//                          --json PATH, --baseline PATH, --tolerance PCT,
+//                          --samples N
+//  --soak [MINUTES] [SKILL]  play the drills unattended with the simulated
+//                          player (novice/average/skilled/pro) and print
+//                          the score distribution per drill
+//  --replay [PATH...]      re-simulate recorded sessions (files or folders,
+//                          default "replays") and check their scores
+//  --shots [PATH...]       per-shot telemetry (default "telemetry") as CSV
+//  --sweep [...]           score distributions over a grid of drill
+//                          parameters x input profiles on all cores, CSV
+//                          on stdout (options at namespace Sweep)
+//  --trace-latency [PATH]  input-to-present latency per input event from a
+//                          trace (default aimtrainer_trace.json), CSV
+//
+// Tracing: define AIMTRAINER_TRACE (CMake -DAIMTRAINER_TRACE=ON) and the
+// game writes aimtrainer_trace.json on exit, Chrome trace format for
+// Perfetto or chrome://tracing.
 
 #define _CRT_SECURE_NO_WARNINGS
 #define _USE_MATH_DEFINES
@@ -20,125 +57,761 @@
 #include <fstream>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <type_traits>
+#include <unordered_map>
+#include <ctime>
+#include <string_view>
+#include <charconv>
+#include <sstream>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 // clamp macro
 #define CLAMP(v, lo, hi) (((v)<(lo))?(lo):((v)>(hi))?(hi):(v))
 
-static const int   WINDOW_WIDTH = 1280;
-static const int   WINDOW_HEIGHT = 720;
+static const int   DEFAULT_WINDOW_WIDTH = 1280;
+static const int   DEFAULT_WINDOW_HEIGHT = 720;
+static const int   MIN_UI_WIDTH = 1024;    // UI units the menus need
+static const int   MIN_UI_HEIGHT = 720;
 static const Uint32 GAME_DURATION_MS = 60000;
 static const Uint32 COUNTDOWN_DURATION_MS = 3000;
 static const char* DATA_FILE = "aimtrainer_data.json";
+static const char* SCORE_LOG = "aimtrainer_scores.log";
+static const char* SCENARIO_DIR = "scenarios";
+static const char* SCENARIO_CACHE = "aimtrainer_scenarios.bin";
 
 // --- Shared config ---
 struct GameConfig {
     float sensitivity;
     float fov;
     bool  challengeMode;
+    // legacy score arrays: only read to migrate them into ScoreLog
     std::vector<double> gridshotScores;
     std::vector<double> trackingScores;
+    std::vector<double> swarmScores;
     int cross_r, cross_g, cross_b;
     int cross_gap, cross_len;
+    int tickRate;   // simulation ticks per second
+    int pacingMode; // PacingMode
+    int fpsCap;
+    bool fullscreen;   // borderless fullscreen desktop, toggled with F11
+    bool dynamicResolution;   // let ResolutionGovernor lower the scene resolution
+    int trackPattern;  // MotionPattern for TrackingMode
+    int trackTargets;  // simultaneous tracking targets
 } config;
 
+// --- View ---
+// Render output size in pixels and how the window maps to it. Rebuilt by
+// syncView() when the window is created, resized or moved to a display
+// with another scale; the projection and menu layouts are recomputed only
+// then. Menus and HUD text are laid out in UI units (pixels / scale), the
+// 3D view is drawn in raw pixels so targets land on native pixels.
+struct View {
+    int   w = DEFAULT_WINDOW_WIDTH, h = DEFAULT_WINDOW_HEIGHT;
+    float density = 1.0f;   // pixels per window coordinate (mouse positions)
+    float scale = 1.0f;     // pixels per UI unit
+    int uiW() const { return int(w / scale); }
+    int uiH() const { return int(h / scale); }
+    // window coordinates -> UI units
+    int toUi(float c) const { return int(c * density / scale); }
+} view;
+
+// --- Frame pacing modes ---
+enum PacingMode { PACE_UNCAPPED, PACE_CAPPED, PACE_VSYNC, PACE_ADAPTIVE, PACE_COUNT };
+static const char* PACING_NAMES[PACE_COUNT] = { "Uncapped", "FPS Cap", "VSync", "Adaptive" };
+static const int MENU_FPS_CAP = 60;
+static const int MIN_FPS_CAP = 30, MAX_FPS_CAP = 1000;   // config.fpsCap range
+
+// --- Session modes (score log, replays, menu rows) ---
+enum SessionMode : Uint8 { MODE_GRIDSHOT, MODE_TRACKING, MODE_SWARM, MODE_COUNT };
+static const char* MODE_NAMES[MODE_COUNT] = { "gridshot", "tracking", "swarm" };
+
+// --- Tracking target motion (MotionEngine) ---
+enum MotionPattern { MOTION_BOUNCE, MOTION_STRAFE, MOTION_ACCEL, MOTION_SPLINE, MOTION_ADAD, MOTION_COUNT };
+static const char* MOTION_NAMES[MOTION_COUNT] = { "bounce", "strafe", "accel", "spline", "adad" };
+static const int MAX_TRACK_TARGETS = 8;
+
+// --- Scenario (drill parameters) ---
+// Everything that defines a drill. The built-ins are the classic modes;
+// custom drills are compiled from scenarios/*.json by Scenarios::Library.
+// Plain data with no padding: the scenario cache and replays store it byte
+// for byte, so a layout change needs Scenarios::CACHE_VERSION and
+// Replay::VERSION bumped.
+static const int MAX_GRID = 8;   // gridshot cells per side
+static const int MAX_SWARM_TARGETS = 100000;
+struct Scenario {
+    Uint64 id;                // FNV-1a of the source file, 0 for built-ins
+    char   name[32];
+    int    mode;              // SessionMode
+    int    pattern;           // MotionPattern (tracking)
+    int    durationMs, countdownMs;
+    int    targets;           // live at once (gridshot: at the start)
+    int    challengeTargets;  // the same in challenge mode
+    int    gridCols, gridRows;     // gridshot spawn cells
+    int    hitScore, missPenalty;  // per click (gridshot, swarm)
+    double span;              // gridshot: angle between the outer cells (deg)
+    double size, maxSize;     // hit half-size (deg); swarm sizes are in [size, maxSize]
+    double drawSize;          // gridshot/tracking: drawn half-size (px at UI scale 1)
+    double speed;             // tracking: deg/s
+    double fieldYaw, fieldPitch;   // swarm: spawn half-extents (deg)
+    double challenge;         // challenge mode factor: drawn size (gridshot),
+                              // hit size (swarm), speed and score (tracking)
+
+    static Scenario builtin(int mode) {
+        Scenario s;
+        memset(&s, 0, sizeof(s));
+        s.mode = mode;
+        s.durationMs = GAME_DURATION_MS;
+        s.countdownMs = COUNTDOWN_DURATION_MS;
+        s.gridCols = s.gridRows = 3;
+        s.hitScore = 1;
+        s.span = 30.0;
+        s.drawSize = 20.0;
+        s.fieldYaw = 180.0; s.fieldPitch = 45.0;
+        switch (mode) {
+        case MODE_GRIDSHOT:
+            strcpy(s.name, "Gridshot");
+            s.targets = 5; s.challengeTargets = 2;
+            s.size = s.maxSize = 2.0;
+            s.challenge = 0.5;
+            break;
+        case MODE_TRACKING:
+            strcpy(s.name, "Tracking");
+            s.pattern = MOTION_BOUNCE;
+            s.targets = s.challengeTargets = 1;
+            s.size = s.maxSize = 3.0;
+            s.speed = 20.0;
+            s.challenge = 2.0;
+            break;
+        default:
+            strcpy(s.name, "Swarm");
+            s.targets = s.challengeTargets = 2000;
+            s.size = 0.4; s.maxSize = 1.2;
+            s.challenge = 0.5;
+            break;
+        }
+        return s;
+    }
+};
+static_assert(sizeof(Scenario) == 144, "scenario record layout");
+
+// --- Deterministic RNG ---
+// splitmix64. Unlike rand()/random_shuffle its sequence is the same on
+// every compiler and platform, so a recorded seed replays exactly.
+struct Rng {
+    Uint64 s = 0x853C49E6748FEA9Bull;
+    void seed(Uint64 v) { s = v; }
+    Uint64 next() {
+        Uint64 z = (s += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    int below(int n) { return int((next() >> 32) % Uint64(n)); }
+    double uniform(double lo, double hi) {
+        return lo + (hi - lo) * ((next() >> 11) * (1.0 / 9007199254740992.0));
+    }
+    // standard normal (Box-Muller, one of the pair)
+    double normal() {
+        double u = uniform(1e-300, 1.0), v = uniform(0, 2 * M_PI);
+        return sqrt(-2 * log(u)) * cos(v);
+    }
+};
+
+// --- Projection ---
+// Rectilinear yaw/pitch -> pixel mapping for the current FOV and resolution.
+// Rebuilt only when either changes (update() is a cheap compare), so the
+// per-target cost is just the tan of the angle offsets.
+static inline float fastTan(float x) {
+    // sin/cos series, < 1e-6 relative error for |x| < 1.4 rad (80 deg);
+    // no libm call, so loops over arrays of angles vectorize
+    float x2 = x * x;
+    float s = x * (1 + x2 * (-1.f / 6 + x2 * (1.f / 120 + x2 * (-1.f / 5040
+        + x2 * (1.f / 362880 + x2 * (-1.f / 39916800))))));
+    float c = 1 + x2 * (-0.5f + x2 * (1.f / 24 + x2 * (-1.f / 720
+        + x2 * (1.f / 40320 + x2 * (-1.f / 3628800 + x2 * (1.f / 479001600))))));
+    return s / c;
+}
+
+struct Projection {
+    double fov = 0;              // horizontal FOV it was built for (deg)
+    int    w = 0, h = 0;
+    double hFov = 0, vFov = 0;   // degrees
+    double kx = 0, ky = 0;       // pixels per unit of tan(angle)
+    double cx = 0, cy = 0;       // screen center
+
+    void rebuild(double fovDeg, int width, int height) {
+        fov = fovDeg; w = width; h = height;
+        double asp = double(w) / h;
+        double tanH = tan(fov * M_PI / 180.0 / 2);
+        hFov = fov;
+        vFov = (180.0 / M_PI) * 2 * atan(tanH / asp);
+        cx = w / 2; cy = h / 2;
+        kx = (w / 2) / tanH;
+        ky = (h / 2) / (tanH / asp);
+    }
+    void update(double fovDeg, int width, int height) {
+        if (fovDeg != fov || width != w || height != h) rebuild(fovDeg, width, height);
+    }
+
+    // dy/dp: target minus camera, degrees, yaw already wrapped to [-180,180].
+    // False if further than margin degrees outside the view.
+    bool project(double dy, double dp, double margin, int& x, int& y) const {
+        if (fabs(dy) > hFov / 2 + margin || fabs(dp) > vFov / 2 + margin) return false;
+        x = int(tan(dy * M_PI / 180.0) * kx + cx);
+        y = int(-tan(dp * M_PI / 180.0) * ky + cy);
+        return true;
+    }
+
+    // Batched kernel over structure-of-arrays offsets. Pass 1 is branch-free
+    // and vectorizes; pass 2 compacts the indices of targets within the view
+    // (+margin) into visible[] and returns how many there are.
+    int projectBatch(const float* dyaw, const float* dpitch, int n, float margin,
+        float* outX, float* outY, int* visible) const {
+        const float kxf = float(kx), kyf = float(ky), cxf = float(cx), cyf = float(cy);
+        const float d2r = float(M_PI / 180.0);
+        for (int i = 0;i < n;++i) {
+            outX[i] = fastTan(dyaw[i] * d2r) * kxf + cxf;
+            outY[i] = cyf - fastTan(dpitch[i] * d2r) * kyf;
+        }
+        const float limY = float(hFov / 2) + margin, limP = float(vFov / 2) + margin;
+        int m = 0;
+        for (int i = 0;i < n;++i) {
+            visible[m] = i;
+            m += (fabsf(dyaw[i]) <= limY) & (fabsf(dpitch[i]) <= limP);
+        }
+        return m;
+    }
+};
+
+// --- Session context ---
+// Everything a session's simulation reads besides its Scenario: mouse
+// sensitivity and the view it is played in (the FOV and aspect bound the
+// tracking area and what a player can see). liveContext is kept in step
+// with config and the window and is what frames are drawn with; a live
+// session runs in a copy of it taken at its start, and headless runs,
+// replays and sweep workers each own one, so sessions can run on any thread
+// at once.
+struct SessionContext {
+    float sensitivity = 1.0f;   // deg per mouse count
+    float fov = 90.0f;          // horizontal (deg)
+    int   viewW = DEFAULT_WINDOW_WIDTH, viewH = DEFAULT_WINDOW_HEIGHT;
+    Projection proj;            // from fov and the view size, see sync()
+
+    void sync() { proj.update(fov, viewW, viewH); }
+};
+static SessionContext liveContext;
+
+// --- Shot telemetry ---
+// One row per click of a live session: play time, where the aim was
+// relative to the target it hit or the nearest one, how far the aim moved
+// since the previous click, how long that target had been up, hit or miss.
+// The columns are sized at begin() for a click rate nobody reaches, so a
+// click only stores; Telemetry encodes them once the session is over.
+class ShotLog {
+public:
+    static const int MAX_CLICKS_PER_SEC = 50;
+    std::vector<Uint32> timeUs;             // since the countdown ended
+    std::vector<float>  yawErr, pitchErr;   // aim minus target (deg, + = right/up)
+    std::vector<float>  flick;              // aim travel since the previous click (deg)
+    std::vector<Uint32> ageUs;              // target lifetime: spawn to this click
+    std::vector<Uint8>  hit;
+    size_t n = 0;
+    Uint32 dropped = 0;
+
+    void begin(int durationMs, double camYaw, double camPitch) {
+        size_t cap = size_t(durationMs / 1000 + 1) * MAX_CLICKS_PER_SEC;
+        if (timeUs.size() < cap) {
+            timeUs.resize(cap); yawErr.resize(cap); pitchErr.resize(cap);
+            flick.resize(cap); ageUs.resize(cap); hit.resize(cap);
+        }
+        n = 0;
+        dropped = 0;
+        lastYaw = camYaw;
+        lastPitch = camPitch;
+    }
+    void add(Uint64 playNS, double cy, double cp, double dYaw, double dPitch, Uint64 ageNS, bool isHit) {
+        if (n == timeUs.size()) { ++dropped; return; }
+        double my = cy - lastYaw, mp = cp - lastPitch;
+        if (my > 180) my -= 360; else if (my < -180) my += 360;
+        timeUs[n] = Uint32(playNS / 1000);
+        yawErr[n] = float(dYaw);
+        pitchErr[n] = float(dPitch);
+        flick[n] = float(sqrt(my * my + mp * mp));
+        ageUs[n] = Uint32(ageNS / 1000);
+        hit[n] = isHit;
+        ++n;
+        lastYaw = cy;
+        lastPitch = cp;
+    }
+private:
+    double lastYaw = 0, lastPitch = 0;
+};
+
+// --- Render snapshots ---
+// What a session frame draws, copied out of the mode by the simulation
+// thread each time it has run the ticks due (GameMode::snapshot). Moving
+// state (camera, tracking targets) also carries its value at the previous
+// publish, so the render thread blends between the two latest publishes
+// from one snapshot. SnapshotBuffer fills the prev* fields.
+struct Snapshot {
+    struct Target { double yaw, pitch; float rad; };   // rad: drawn half-size (deg), swarm
+    Uint32 session = 0;              // sessions started so far; the prev* fields never cross one
+    Uint64 prevNS = 0, timeNS = 0;   // wall clock at the end of the last tick run
+    double prevYaw = 0, prevPitch = 0, camYaw = 0, camPitch = 0;
+    float  viewYaw = 45, viewPitch = 30;   // set by the publisher: half extents (deg) to cover
+    Uint64 countdown = 0, timeRem = 0;     // ns
+    double score = 0, streak = 0;          // tracking: seconds on target, best run
+    bool   challenge = false;
+    bool   moving = false;                 // targets move: prevTargets holds them at prevNS
+    double drawSize = 0;                   // gridshot/tracking: px at UI scale 1
+    double reach = 0;                      // largest drawn half-size (deg)
+    Uint64 inputs = 0;                     // input events applied by then (Trace::consumedCount)
+    std::vector<Target> targets, prevTargets;
+
+    // How far from prev* to the latest state to draw at nowNS: one publish
+    // interval behind, so there is always a published state to blend toward.
+    float blend(Uint64 nowNS) const {
+        if (timeNS <= prevNS || nowNS >= timeNS + (timeNS - prevNS)) return 1.0f;
+        return nowNS <= timeNS ? 0.0f : float(double(nowNS - timeNS) / double(timeNS - prevNS));
+    }
+    double yaw(float a) const {
+        double d = camYaw - prevYaw;
+        if (d > 180) d -= 360; else if (d < -180) d += 360;
+        return prevYaw + d * a;
+    }
+    double pitch(float a) const { return prevPitch + (camPitch - prevPitch) * a; }
+    Target target(size_t i, float a) const {
+        Target t = targets[i];
+        if (moving && i < prevTargets.size()) {
+            t.yaw = prevTargets[i].yaw + (t.yaw - prevTargets[i].yaw) * a;
+            t.pitch = prevTargets[i].pitch + (t.pitch - prevTargets[i].pitch) * a;
+        }
+        return t;
+    }
+};
+
 // --- Base class for modes ---
+struct TargetInfo { double yaw, pitch, rad; };   // rad: hit half-size (deg)
+
 class GameMode {
 public:
+    Scenario scenario;   // read by start(); change it between sessions only
+    explicit GameMode(int mode) : scenario(Scenario::builtin(mode)) {}
     virtual void start() = 0;
     virtual void toggleChallengeMode() = 0;
+    // the live targets a player looking at cy/cp could go for (SimPlayer)
+    virtual void listTargets(double cy, double cp, std::vector<TargetInfo>& out) const = 0;
+    // everything render() draws; the caller has set the camera and view
+    virtual void snapshot(Snapshot& s) const = 0;
     virtual ~GameMode() {}
+    void seed(Uint64 s) { rng.seed(s); }
+    bool isChallengeMode() const { return challengeMode; }
+    const SessionContext* ctx = &liveContext;   // settings the session runs with
+    ShotLog* shots = nullptr;   // live sessions: every click is logged here
+protected:
+    Rng  rng;   // all session randomness comes from here
+    bool challengeMode = false;
 };
 
-// --- JSON load/save ---
-static void trim(std::string& s) {
-    size_t a = s.find_first_not_of(" \t\r\n");
-    size_t b = s.find_last_not_of(" \t\r\n");
-    if (a == std::string::npos) s.clear();
-    else s = s.substr(a, b - a + 1);
+// --- File helpers ---
+// reads all of path into out
+static bool readFile(const char* path, std::string& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    out.clear();
+    char buf[16384];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.append(buf, n);
+    bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+// flushes stdio and the OS cache for f to the device
+static bool syncFile(FILE* f) {
+    if (fflush(f) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+// Replaces path with data via a synced temp file and a rename, so a crash
+// leaves either the old or the new contents, never a truncated file.
+static bool writeFileAtomic(const char* path, const void* data, size_t size) {
+    std::string tmp = std::string(path) + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(data, 1, size, f) == size && syncFile(f);
+    ok &= fclose(f) == 0;
+    if (ok) ok = SDL_RenamePath(tmp.c_str(), path);
+    if (!ok) SDL_RemovePath(tmp.c_str());
+    return ok;
+}
+
+// --- Tracing (build with AIMTRAINER_TRACE) ---
+// TRACE_SCOPE(name[, frame]) spans on the hot path, for finding where the
+// time goes between a mouse event arriving and the frame showing it being
+// presented. Each thread records into its own ring (the newest CAPACITY
+// spans survive, minutes of play), so a span costs two clock reads and a
+// store. Input events are counted as they are applied; endFrame() tags
+// those a presented frame showed with its number. The game writes
+// TRACE_FILE (Chrome trace JSON, opens in Perfetto) on exit, and
+// --trace-latency turns it into per-input latencies. Without the define
+// every call compiles away.
+static const char* TRACE_FILE = "aimtrainer_trace.json";
+#ifdef AIMTRAINER_TRACE
+namespace Trace {
+    struct Span { const char* name; Uint64 beginNS, endNS, frame; };   // endNS 0: input at beginNS
+
+    struct Buffer {
+        static const Uint32 CAPACITY = 1 << 20;   // power of two
+        std::vector<Span> spans;   // reserved whole, pages get touched as it fills
+        Uint64 n = 0;              // recorded so far
+        std::string name = "thread";
+        Buffer() { spans.reserve(CAPACITY); }
+        void add(const Span& s) {
+            if (spans.size() < CAPACITY) spans.push_back(s);
+            else spans[n & (CAPACITY - 1)] = s;
+            ++n;
+        }
+    };
+    // buffers outlive their threads, save() reads them once those joined
+    static SDL_SpinLock registryLock = 0;
+    static std::vector<Buffer*> registry;
+    static Buffer& local() {
+        static thread_local Buffer* b = nullptr;
+        if (!b) {
+            b = new Buffer;
+            SDL_LockSpinlock(&registryLock);
+            registry.push_back(b);
+            SDL_UnlockSpinlock(&registryLock);
+        }
+        return *b;
+    }
+    static void nameThread(const char* name) { local().name = name; }
+    // a span timed by the caller
+    static void span(const char* name, Uint64 beginNS, Uint64 endNS, Uint64 frame = 0) {
+        local().add({ name, beginNS, std::max(endNS, beginNS + 1), frame });
+    }
+
+    class Scope {
+        const char* name;
+        Uint64 frame, t0;
+    public:
+        explicit Scope(const char* n, Uint64 f = 0) : name(n), frame(f), t0(SDL_GetTicksNS()) {}
+        ~Scope() { local().add({ name, t0, SDL_GetTicksNS(), frame }); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    // Input events applied so far and their SDL timestamps. One thread
+    // applies input at a time (menus or the simulation); the render thread
+    // reads the times of those a snapshot says were applied.
+    static const Uint32 INPUT_RING = 8192;   // power of two
+    static std::atomic<Uint64> inputTimes[INPUT_RING];
+    static std::atomic<Uint64> inputsApplied{ 0 };
+    static Uint64 inputsShown = 0, frameNo = 1;   // render thread
+
+    static void consumed(Uint64 eventNS) {
+        Uint64 n = inputsApplied.load(std::memory_order_relaxed);
+        inputTimes[n & (INPUT_RING - 1)].store(eventNS, std::memory_order_relaxed);
+        inputsApplied.store(n + 1, std::memory_order_release);
+    }
+    static Uint64 consumedCount() { return inputsApplied.load(std::memory_order_acquire); }
+    static Uint64 frame() { return frameNo; }
+    // The frame just presented shows the inputs up to upTo (a
+    // consumedCount()); records one "input" per new one at its timestamp.
+    static void endFrame(Uint64 upTo) {
+        Buffer& b = local();
+        if (upTo > inputsShown + INPUT_RING) inputsShown = upTo - INPUT_RING;
+        for (; inputsShown < upTo; ++inputsShown)
+            b.add({ "input", inputTimes[inputsShown & (INPUT_RING - 1)].load(std::memory_order_relaxed),
+                0, frameNo });
+        ++frameNo;
+    }
+
+    static bool save(const char* path) {
+        SDL_LockSpinlock(&registryLock);
+        std::vector<Buffer*> bufs = registry;
+        SDL_UnlockSpinlock(&registryLock);
+        std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        char line[256];
+        size_t spans = 0;
+        for (size_t t = 0; t < bufs.size(); ++t) {
+            const Buffer& b = *bufs[t];
+            snprintf(line, sizeof(line),
+                "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"%s\"}}",
+                t + 1, b.name.c_str());
+            out += line;
+            for (Uint64 i = b.n > Buffer::CAPACITY ? b.n - Buffer::CAPACITY : 0; i < b.n; ++i) {
+                const Span& s = b.spans[i & (Buffer::CAPACITY - 1)];
+                if (!s.endNS)
+                    snprintf(line, sizeof(line),
+                        ",\n{\"name\":\"input\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,"
+                        "\"args\":{\"frame\":%llu}}", t + 1, s.beginNS / 1e3, (unsigned long long)s.frame);
+                else if (s.frame)
+                    snprintf(line, sizeof(line),
+                        ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f,"
+                        "\"args\":{\"frame\":%llu}}", s.name, t + 1, s.beginNS / 1e3,
+                        (s.endNS - s.beginNS) / 1e3, (unsigned long long)s.frame);
+                else
+                    snprintf(line, sizeof(line),
+                        ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f}",
+                        s.name, t + 1, s.beginNS / 1e3, (s.endNS - s.beginNS) / 1e3);
+                out += line;
+                ++spans;
+            }
+            out += t + 1 < bufs.size() ? ",\n" : "\n";
+        }
+        out += "]}\n";
+        bool ok = writeFileAtomic(path, out.data(), out.size());
+        if (ok) SDL_Log("Trace: %zu spans on %zu threads written to %s", spans, bufs.size(), path);
+        else SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Could not write %s", path);
+        return ok;
+    }
 }
+#define TRACE_JOIN2(a, b) a##b
+#define TRACE_JOIN(a, b) TRACE_JOIN2(a, b)
+#define TRACE_SCOPE(...) Trace::Scope TRACE_JOIN(traceScope, __LINE__)(__VA_ARGS__)
+#else
+namespace Trace {
+    static inline void nameThread(const char*) {}
+    static inline void span(const char*, Uint64, Uint64, Uint64 = 0) {}
+    static inline void consumed(Uint64) {}
+    static inline Uint64 consumedCount() { return 0; }
+    static inline Uint64 frame() { return 0; }
+    static inline void endFrame(Uint64) {}
+    static inline bool save(const char*) { return true; }
+}
+#define TRACE_SCOPE(...) ((void)0)
+#endif
 
+// --- JSON load/save ---
+// loadConfig tokenizes the file in one pass over a string_view: no copies
+// of keys or numbers, numbers go through std::from_chars, and keys are
+// looked up in SCHEMA. Unknown keys are skipped; malformed input, and
+// numbers that are not finite or fall outside their field's range, stop the
+// parse with the byte offset of the problem.
 namespace JSONStorage {
-    bool loadConfig(GameConfig& cfg) {
-        std::ifstream in(DATA_FILE);
-        if (!in.is_open()) {
-            cfg.sensitivity = 1.0f;
-            cfg.fov = 90.0f;
-            cfg.challengeMode = false;
-            cfg.cross_r = 0;
-            cfg.cross_g = 255;
-            cfg.cross_b = 0;
-            cfg.cross_gap = 5;
-            cfg.cross_len = 15;
+    // lo/hi: the range a number may load with (main() still swaps
+    // unusable values such as a zero sensitivity for the default)
+    struct Field {
+        std::string_view key;
+        double def, lo = 0, hi = 0;
+        float GameConfig::* f = nullptr;
+        int   GameConfig::* i = nullptr;
+        bool  GameConfig::* b = nullptr;
+        std::vector<double> GameConfig::* a = nullptr;
+        Field(std::string_view k, double d, double l, double h, float GameConfig::* p) : key(k), def(d), lo(l), hi(h), f(p) {}
+        Field(std::string_view k, double d, double l, double h, int GameConfig::* p) : key(k), def(d), lo(l), hi(h), i(p) {}
+        Field(std::string_view k, double d, bool GameConfig::* p) : key(k), def(d), b(p) {}
+        Field(std::string_view k, std::vector<double> GameConfig::* p) : key(k), def(0), a(p) {}
+    };
+    static const Field SCHEMA[] = {
+        { "sensitivity",   1.0,  0, 100,    &GameConfig::sensitivity },
+        { "fov",           90.0, 1, 179,    &GameConfig::fov },
+        { "challengeMode", 0,    &GameConfig::challengeMode },
+        { "cross_r",       0,    0, 255,    &GameConfig::cross_r },
+        { "cross_g",       255,  0, 255,    &GameConfig::cross_g },
+        { "cross_b",       0,    0, 255,    &GameConfig::cross_b },
+        { "cross_gap",     5,    0, 1000,   &GameConfig::cross_gap },
+        { "cross_len",     15,   0, 1000,   &GameConfig::cross_len },
+        { "tickRate",      1000, 1, 100000, &GameConfig::tickRate },
+        { "pacingMode",    PACE_CAPPED, 0, PACE_COUNT - 1, &GameConfig::pacingMode },
+        { "fpsCap",        240,  MIN_FPS_CAP, MAX_FPS_CAP, &GameConfig::fpsCap },
+        { "fullscreen",    0,    &GameConfig::fullscreen },
+        { "dynamicResolution", 1, &GameConfig::dynamicResolution },
+        { "trackPattern",  MOTION_BOUNCE, 0, MOTION_COUNT - 1, &GameConfig::trackPattern },
+        { "trackTargets",  1,    1, MAX_TRACK_TARGETS, &GameConfig::trackTargets },
+        { "gridshot_high_scores", &GameConfig::gridshotScores },
+        { "tracking_high_scores", &GameConfig::trackingScores },
+        { "swarm_high_scores",    &GameConfig::swarmScores },
+    };
+
+    static void setDefaults(GameConfig& cfg) {
+        for (const Field& fd : SCHEMA) {
+            if (fd.f) cfg.*fd.f = float(fd.def);
+            else if (fd.i) cfg.*fd.i = int(fd.def);
+            else if (fd.b) cfg.*fd.b = fd.def != 0;
+            else (cfg.*fd.a).clear();
+        }
+    }
+
+    class Parser {
+    public:
+        const char* error = nullptr;
+        size_t errorPos = 0;
+
+        explicit Parser(std::string_view text) : s(text) {}
+
+        bool parse(GameConfig& cfg) {
+            return object([&](std::string_view key) {
+                for (const Field& f : SCHEMA) if (f.key == key) return value(cfg, f);
+                return skip(0);
+            });
+        }
+        // Walks one top-level object; member(key) must consume the value.
+        template<class F>
+        bool object(F&& member) {
+            ws();
+            if (!expect('{')) return false;
+            ws();
+            if (peek('}')) return true;
+            for (;;) {
+                std::string_view key;
+                ws();
+                if (!string(key)) return false;
+                ws();
+                if (!expect(':')) return false;
+                ws();
+                if (!member(key)) return false;
+                ws();
+                if (peek('}')) return true;
+                if (!peek(',')) return fail("expected ',' or '}'");
+            }
+        }
+        // Walks an array; element() must consume each value.
+        template<class F>
+        bool array(F&& element) {
+            if (!expect('[')) return false;
+            ws();
+            if (peek(']')) return true;
+            for (;;) {
+                ws();
+                if (!element()) return false;
+                ws();
+                if (peek(']')) return true;
+                if (!peek(',')) return fail("expected ',' or ']'");
+            }
+        }
+        bool fail(const char* what) {
+            if (!error) { error = what; errorPos = p; }
             return false;
         }
-        std::string txt((std::istreambuf_iterator<char>(in)), {});
-        in.close();
-        txt.erase(std::remove_if(txt.begin(), txt.end(),
-            [](char c) {return c == '\n' || c == '\r' || c == '\t';}), txt.end());
+        // a view of the raw characters between the quotes (escapes left as-is)
+        bool string(std::string_view& out) {
+            if (!expect('"')) return false;
+            size_t b = p;
+            while (p < s.size() && s[p] != '"') p += (s[p] == '\\') ? 2 : 1;
+            if (p >= s.size()) return fail("unterminated string");
+            out = s.substr(b, p++ - b);
+            return true;
+        }
+        bool number(double& v) {
+            const char* b = s.data() + p;
+            std::from_chars_result r = std::from_chars(b, s.data() + s.size(), v);
+            // from_chars also takes "nan" and "inf"; JSON has neither
+            if (r.ec != std::errc() || !std::isfinite(v)) return fail("expected a number");
+            p += size_t(r.ptr - b);
+            return true;
+        }
+        // skips any value under a key we do not know
+        bool skip(int depth) {
+            if (depth > 64) return fail("nested too deeply");
+            if (p >= s.size()) return fail("unexpected end of file");
+            std::string_view str;
+            double v;
+            char c = s[p];
+            if (c == '"') return string(str);
+            if (c == '{' || c == '[') {
+                char close = c == '{' ? '}' : ']';
+                ++p;
+                ws();
+                if (peek(close)) return true;
+                for (;;) {
+                    ws();
+                    if (c == '{') {
+                        if (!string(str)) return false;
+                        ws();
+                        if (!expect(':')) return false;
+                        ws();
+                    }
+                    if (!skip(depth + 1)) return false;
+                    ws();
+                    if (peek(close)) return true;
+                    if (!peek(',')) return fail(c == '{' ? "expected ',' or '}'" : "expected ',' or ']'");
+                }
+            }
+            if (literal("true") || literal("false") || literal("null")) return true;
+            return number(v);
+        }
+    private:
+        std::string_view s;
+        size_t p = 0;
 
-        auto parseFloat = [&](const char* key, float def) {
-            size_t p = txt.find(key);
-            if (p == std::string::npos) return def;
-            size_t c = txt.find(':', p);
-            size_t e = txt.find_first_of(",}", c + 1);
-            std::string num = txt.substr(c + 1, e - c - 1);
-            trim(num);
-            return num.empty() ? def : std::stof(num);
-            };
-        auto parseInt = [&](const char* key, int def) {
-            size_t p = txt.find(key);
-            if (p == std::string::npos) return def;
-            size_t c = txt.find(':', p);
-            size_t e = txt.find_first_of(",}", c + 1);
-            std::string num = txt.substr(c + 1, e - c - 1);
-            trim(num);
-            return num.empty() ? def : std::stoi(num);
-            };
-        auto parseBool = [&](const char* key, bool def) {
-            size_t p = txt.find(key);
-            if (p == std::string::npos) return def;
-            size_t c = txt.find(':', p);
-            size_t e = txt.find_first_of(",}", c + 1);
-            std::string val = txt.substr(c + 1, e - c - 1);
-            trim(val);
-            return val == "true";
-            };
-        auto parseArray = [&](const char* key, std::vector<double>& out) {
-            out.clear();
-            size_t p = txt.find(key);
-            if (p == std::string::npos) return;
-            size_t b = txt.find('[', p), e = txt.find(']', b);
-            if (b == std::string::npos || e == std::string::npos) return;
-            std::string sub = txt.substr(b + 1, e - b - 1);
-            size_t pos = 0;
-            while (pos < sub.size()) {
-                size_t c = sub.find(',', pos);
-                std::string num = (c == std::string::npos
-                    ? sub.substr(pos)
-                    : sub.substr(pos, c - pos));
-                trim(num);
-                if (!num.empty()) out.push_back(std::stod(num));
-                if (c == std::string::npos) break;
-                pos = c + 1;
+        void ws() { while (p < s.size() && (s[p] == ' ' || s[p] == '\t' || s[p] == '\n' || s[p] == '\r')) ++p; }
+        bool peek(char c) {
+            if (p < s.size() && s[p] == c) { ++p; return true; }
+            return false;
+        }
+        bool expect(char c) {
+            if (peek(c)) return true;
+            switch (c) {
+            case '{': return fail("expected '{'");
+            case '[': return fail("expected '['");
+            case ':': return fail("expected ':'");
+            case '"': return fail("expected a string");
+            default:  return fail("unexpected character");
             }
-            };
+        }
+        bool literal(std::string_view word) {
+            if (s.substr(p, word.size()) != word) return false;
+            p += word.size();
+            return true;
+        }
+        bool value(GameConfig& cfg, const Field& fd) {
+            double v;
+            if (fd.b) {
+                if (literal("true")) cfg.*fd.b = true;
+                else if (literal("false")) cfg.*fd.b = false;
+                else return fail("expected true or false");
+                return true;
+            }
+            if (!fd.a) {
+                size_t at = p;
+                if (!number(v)) return false;
+                if (!(v >= fd.lo && v <= fd.hi)) { p = at; return fail("value out of range"); }
+                if (fd.f) cfg.*fd.f = float(v);
+                else cfg.*fd.i = int(v);
+                return true;
+            }
+            std::vector<double>& out = cfg.*fd.a;
+            out.clear();
+            return array([&] {
+                if (!number(v)) return false;
+                out.push_back(v);
+                return true;
+                });
+        }
+    };
 
-        cfg.sensitivity = parseFloat("\"sensitivity\"", 1.0f);
-        cfg.fov = parseFloat("\"fov\"", 90.0f);
-        cfg.challengeMode = parseBool("\"challengeMode\"", false);
-        cfg.cross_r = parseInt("\"cross_r\"", 0);
-        cfg.cross_g = parseInt("\"cross_g\"", 255);
-        cfg.cross_b = parseInt("\"cross_b\"", 0);
-        cfg.cross_gap = parseInt("\"cross_gap\"", 5);
-        cfg.cross_len = parseInt("\"cross_len\"", 15);
-        parseArray("\"gridshot_high_scores\"", cfg.gridshotScores);
-        parseArray("\"tracking_high_scores\"", cfg.trackingScores);
-        return true;
+    bool loadConfig(GameConfig& cfg, const char* path = DATA_FILE) {
+        TRACE_SCOPE("json.loadConfig");
+        setDefaults(cfg);
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) return false;
+        in.seekg(0, std::ios::end);
+        std::streamoff size = in.tellg();
+        if (size < 0) return false;
+        std::string txt(size_t(size), '\0');
+        in.seekg(0);
+        in.read(&txt[0], txt.size());
+        in.close();
+        Parser parser(txt);
+        if (parser.parse(cfg)) return true;
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "%s: byte %zu: %s",
+            path, parser.errorPos, parser.error);
+        return false;
     }
 
-    bool saveConfig(const GameConfig& cfg) {
-        std::ofstream out(DATA_FILE);
-        if (!out.is_open()) return false;
+    bool saveConfig(const GameConfig& cfg, const char* path = DATA_FILE) {
+        TRACE_SCOPE("json.saveConfig");
+        std::ostringstream out;
         out << "{\n";
         out << "  \"sensitivity\": " << cfg.sensitivity << ",\n";
         out << "  \"fov\": " << cfg.fov << ",\n";
@@ -148,606 +821,4907 @@ namespace JSONStorage {
         out << "  \"cross_b\": " << cfg.cross_b << ",\n";
         out << "  \"cross_gap\": " << cfg.cross_gap << ",\n";
         out << "  \"cross_len\": " << cfg.cross_len << ",\n";
-        out << "  \"gridshot_high_scores\": [";
-        for (size_t i = 0;i < cfg.gridshotScores.size();++i) {
-            out << cfg.gridshotScores[i]
-                << (i + 1 < cfg.gridshotScores.size() ? ", " : "");
-        }
-        out << "],\n";
-        out << "  \"tracking_high_scores\": [";
-        for (size_t i = 0;i < cfg.trackingScores.size();++i) {
-            out << cfg.trackingScores[i]
-                << (i + 1 < cfg.trackingScores.size() ? ", " : "");
-        }
-        out << "]\n}\n";
-        return true;
+        out << "  \"tickRate\": " << cfg.tickRate << ",\n";
+        out << "  \"pacingMode\": " << cfg.pacingMode << ",\n";
+        out << "  \"fpsCap\": " << cfg.fpsCap << ",\n";
+        out << "  \"fullscreen\": " << (cfg.fullscreen ? "true" : "false") << ",\n";
+        out << "  \"dynamicResolution\": " << (cfg.dynamicResolution ? "true" : "false") << ",\n";
+        out << "  \"trackPattern\": " << cfg.trackPattern << ",\n";
+        out << "  \"trackTargets\": " << cfg.trackTargets << "\n";
+        out << "}\n";
+        std::string txt = out.str();
+        return writeFileAtomic(path, txt.data(), txt.size());
     }
 }
 
-// --- Utility ---
-struct Rect { int x, y, w, h; };
-static bool pointInRect(int px, int py, const Rect& r) {
-    return px >= r.x && px <= r.x + r.w && py >= r.y && py <= r.y + r.h;
-}
-static void drawRect(SDL_Renderer* ren, int x, int y, int w, int h, SDL_Color c) {
-    SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
-    SDL_FRect fr{ float(x),float(y),float(w),float(h) };
-    SDL_RenderFillRect(ren, &fr);
-}
-static void drawLine(SDL_Renderer* ren, int x1, int y1, int x2, int y2, SDL_Color c) {
-    SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
-    SDL_RenderLine(ren, float(x1), float(y1), float(x2), float(y2));
-}
+// --- Session analytics ---
+// Streaming per-mode trends for the stats screen. Everything is O(1) per
+// session and never looks at history again, so the screen opens in the
+// same time whatever the history length:
+//  - moving averages: EMAs over ~10 and ~100 sessions
+//  - percentile bands: P-square sketches (Jain & Chlamtac, five markers)
+//  - improvement rate: least-squares slope of score over session index
+//  - breakdown: fixed sensitivity/FOV buckets
+//  - trend chart: mean per `stride` sessions, halving resolution when full
 
-// --- MainMenu ---
-class MainMenu {
+// P-square estimate of the p-quantile of everything added so far.
+class P2Quantile {
 public:
-    Rect btns[4];
-    int hover = -1;
-    MainMenu() {
-        int bw = 200, bh = 40;
-        int cx = WINDOW_WIDTH / 2 - bw / 2;
-        int sy = WINDOW_HEIGHT / 2 - 2 * bh - 20;
-        for (int i = 0;i < 4;++i) btns[i] = { cx,sy + i * 50,bw,bh };
+    explicit P2Quantile(double p = 0.5) : p(p) {}
+    void add(double x) {
+        if (count < 5) {
+            q[count++] = x;
+            if (count == 5) {
+                sortSmall(q, 5);
+                for (int i = 0;i < 5;++i) n[i] = i;
+                double want[5] = { 0, 2 * p, 4 * p, 2 + 2 * p, 4 };
+                double step[5] = { 0, p / 2, p, (1 + p) / 2, 1 };
+                for (int i = 0;i < 5;++i) { np[i] = want[i]; dn[i] = step[i]; }
+            }
+            return;
+        }
+        ++count;
+        int k;
+        if (x < q[0]) { q[0] = x; k = 0; }
+        else if (x >= q[4]) { q[4] = x; k = 3; }
+        else for (k = 0; x >= q[k + 1]; ++k) {}
+        for (int i = k + 1;i < 5;++i) n[i] += 1;
+        for (int i = 0;i < 5;++i) np[i] += dn[i];
+        for (int i = 1;i < 4;++i) {
+            double d = np[i] - n[i];
+            if ((d >= 1 && n[i + 1] - n[i] > 1) || (d <= -1 && n[i - 1] - n[i] < -1)) {
+                int s = d > 0 ? 1 : -1;
+                double qp = q[i] + s / (n[i + 1] - n[i - 1]) *
+                    ((n[i] - n[i - 1] + s) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+                        (n[i + 1] - n[i] - s) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+                if (q[i - 1] < qp && qp < q[i + 1]) q[i] = qp;
+                else q[i] += s * (q[i + s] - q[i]) / (n[i + s] - n[i]);
+                n[i] += s;
+            }
+        }
     }
-    void updateHover(int mx, int my) {
-        hover = -1;
-        for (int i = 0;i < 4;++i)
-            if (pointInRect(mx, my, btns[i])) { hover = i;break; }
+    double value() const {
+        if (count >= 5) return q[2];
+        if (count == 0) return 0;
+        double v[5];
+        std::copy(q, q + count, v);
+        sortSmall(v, count);
+        return v[std::min(count - 1, int(p * count))];
     }
-    void render(SDL_Renderer* ren) {
-        SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
-        SDL_RenderClear(ren);
-        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
-        SDL_RenderDebugText(ren,
-            WINDOW_WIDTH / 2 - 60, WINDOW_HEIGHT / 2 - 150,
-            "FPS AIM TRAINER");
-        const char* labels[4] = {
-            "Gridshot Mode","Tracking Mode","Settings","Credits"
-        };
-        SDL_Color base{ 80,80,80,255 }, hov{ 100,100,100,255 };
-        for (int i = 0;i < 4;++i) {
-            drawRect(ren, btns[i].x, btns[i].y,
-                btns[i].w, btns[i].h,
-                (hover == i ? hov : base));
-            int tx = btns[i].x + btns[i].w / 2 - (int)strlen(labels[i]) * 4;
-            int ty = btns[i].y + btns[i].h / 2 - 4;
-            SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
-            SDL_RenderDebugText(ren, tx, ty, labels[i]);
-        }
-        double bestG = 0, bestT = 0;
-        if (!config.gridshotScores.empty())
-            bestG = *std::max_element(
-                config.gridshotScores.begin(),
-                config.gridshotScores.end());
-        if (!config.trackingScores.empty())
-            bestT = *std::max_element(
-                config.trackingScores.begin(),
-                config.trackingScores.end());
-        char bufG[32], bufT[32];
-        sprintf(bufG, "Best: %.0f", bestG);
-        sprintf(bufT, "Best: %.0f", bestT);
-        SDL_RenderDebugText(ren,
-            btns[0].x + btns[0].w + 5,
-            btns[0].y + btns[0].h / 2 - 4,
-            bufG);
-        SDL_RenderDebugText(ren,
-            btns[1].x + btns[1].w + 5,
-            btns[1].y + btns[1].h / 2 - 4,
-            bufT);
+private:
+    double p;
+    double q[5] = {}, n[5] = {}, np[5] = {}, dn[5] = {};   // heights, positions, desired positions, increments
+    int count = 0;
+
+    static void sortSmall(double* v, int n) {
+        for (int i = 1;i < n;++i)
+            for (int j = i;j > 0 && v[j] < v[j - 1];--j) std::swap(v[j], v[j - 1]);
     }
 };
 
-// --- GridshotMode ---
-class GridshotMode : public GameMode {
-    struct Target { double yaw, pitch;bool active; } t[9];
-    int score = 0, streak = 0;
-    Uint32 timeRem = 0, countdown = 0;
-    bool running = false, challengeMode = false;
-    SDL_Color tgtCol{ 200,50,50,255 };
+class SessionAnalytics {
 public:
-    double targAngRad = 2.0;
-    int    targPixRad = 20;
+    static const int TREND_POINTS = 128;
+    static const int BUCKETS = 7;
+    static constexpr double SENS_EDGES[BUCKETS - 1] = { 0.003, 0.01, 0.03, 0.1, 0.3, 1.0 };
+    static constexpr double FOV_EDGES[BUCKETS - 1] = { 70, 80, 90, 100, 110, 120 };
 
-    bool isInCountdown()const { return countdown > 0; }
-    bool isRunning()    const { return running; }
-    int  getScore()     const { return score; }
+    struct Bucket {
+        Uint64 count = 0;
+        double sum = 0, best = 0;
+        double mean() const { return count ? sum / count : 0; }
+    };
 
-    void start()override {
-        score = streak = 0;
-        timeRem = GAME_DURATION_MS;
-        countdown = COUNTDOWN_DURATION_MS;
-        running = true;
-        std::vector<int> idx(9);
-        for (int i = 0;i < 9;++i) idx[i] = i;
-        std::random_shuffle(idx.begin(), idx.end());
-        int initial = challengeMode ? 2 : 5;
-        for (int i = 0;i < 9;++i) {
-            t[i].active = (i < initial);
-            if (i < initial) {
-                int row = idx[i] / 3, col = idx[i] % 3;
-                double span = 30.0;
-                t[i].yaw = (col - 1) * (span / 2.0);
-                t[i].pitch = (1 - row) * (span / 2.0);
+    Uint64 count = 0;
+    double emaShort = 0, emaLong = 0;
+    P2Quantile q10{ 0.1 }, q50{ 0.5 }, q90{ 0.9 };
+    Bucket bySens[BUCKETS], byFov[BUCKETS];
+    float  trend[TREND_POINTS] = {};
+    int    trendLen = 0;
+
+    void add(double score, float sensitivity, float fov) {
+        ++count;
+        // EMAs start as the running mean until they have enough history
+        emaShort += (score - emaShort) * std::max(2.0 / 11.0, 1.0 / count);
+        emaLong += (score - emaLong) * std::max(2.0 / 101.0, 1.0 / count);
+        q10.add(score);
+        q50.add(score);
+        q90.add(score);
+        // regression on x = session index, Welford-style co-moments
+        double x = double(count - 1);
+        double dx = x - meanX;
+        meanX += dx / count;
+        meanY += (score - meanY) / count;
+        coXY += dx * (score - meanY);
+        coXX += dx * (x - meanX);
+        bucket(bySens[bucketOf(SENS_EDGES, sensitivity)], score);
+        bucket(byFov[bucketOf(FOV_EDGES, fov)], score);
+        pendingSum += score;
+        if (++pendingN == stride) {
+            if (trendLen == TREND_POINTS) {
+                for (int i = 0;i < TREND_POINTS / 2;++i)
+                    trend[i] = 0.5f * (trend[2 * i] + trend[2 * i + 1]);
+                trendLen = TREND_POINTS / 2;
+                stride *= 2;
+            }
+            else {
+                trend[trendLen++] = float(pendingSum / pendingN);
+                pendingSum = 0;
+                pendingN = 0;
             }
         }
     }
+    // score change per session, from the least-squares fit
+    double slope() const { return coXX > 0 ? coXY / coXX : 0; }
+    Uint64 sessionsPerTrendPoint() const { return stride; }
 
-    bool handleClick(double cy, double cp) {
-        for (int i = 0;i < 9;++i) {
-            if (!t[i].active) continue;
-            double dy = t[i].yaw - cy;
-            if (dy > 180) dy -= 360; else if (dy < -180) dy += 360;
-            double dp = t[i].pitch - cp;
-            if (fabs(dy) <= targAngRad && fabs(dp) <= targAngRad) {
-                score++;streak++;
-                t[i].active = false;
-                std::vector<int> freeIdx;
-                for (int k = 0;k < 9;++k)
-                    if (k != i && !t[k].active) freeIdx.push_back(k);
-                if (!freeIdx.empty()) {
-                    int ni = freeIdx[rand() % freeIdx.size()];
-                    t[ni].active = true;
-                    int row = ni / 3, col = ni % 3;
-                    double span = 30.0;
-                    t[ni].yaw = (col - 1) * (span / 2.0);
-                    t[ni].pitch = (1 - row) * (span / 2.0);
-                }
-                return true;
-            }
-        }
-        streak = 0;
-        return false;
+    static const char* sensLabel(int b) {
+        static const char* L[BUCKETS] = { "<0.003", "0.003-0.01", "0.01-0.03", "0.03-0.1",
+            "0.1-0.3", "0.3-1", ">=1" };
+        return L[b];
+    }
+    static const char* fovLabel(int b) {
+        static const char* L[BUCKETS] = { "<70", "70-80", "80-90", "90-100", "100-110",
+            "110-120", ">=120" };
+        return L[b];
     }
+private:
+    double meanX = 0, meanY = 0, coXY = 0, coXX = 0;
+    Uint64 stride = 1, pendingN = 0;
+    double pendingSum = 0;
 
-    void update(Uint32 d, double cy, double cp) {
-        if (!running) return;
-        if (countdown > 0) {
-            countdown = (d > countdown ? 0 : countdown - d);
-            return;
+    static int bucketOf(const double* edges, double v) {
+        int b = 0;
+        while (b < BUCKETS - 1 && v >= edges[b]) ++b;
+        return b;
+    }
+    static void bucket(Bucket& b, double score) {
+        if (b.count++ == 0 || score > b.best) b.best = score;
+        b.sum += score;
+    }
+};
+
+// --- Score log ---
+// Append-only binary history, one fixed-size record per finished session:
+// "AIMS" + version, then Records. Aggregates are rebuilt once on open and
+// then updated per append, so saving a score and drawing the menu do not
+// depend on how long the history is.
+class ScoreLog {
+public:
+    static const Uint32 VERSION = 1;
+    static const size_t WINDOW = 1000;   // sessions in the rolling percentiles
+
+    struct Record {
+        Sint64 time;           // unix seconds, 0 for migrated scores
+        double score;
+        float  sensitivity, fov;
+        Uint32 settingsHash;   // scoring-relevant settings, see settingsHash()
+        Uint8  mode, challenge;
+        Uint8  custom;         // a custom drill: kept out of the per-mode stats
+        Uint8  pad;
+    };
+    static_assert(sizeof(Record) == 32, "score log record layout");
+
+    struct Stats {
+        Uint64 count = 0;
+        double best = 0, sum = 0;
+        std::vector<double> recent, sorted;   // last WINDOW scores, as a ring and sorted
+        size_t head = 0;
+
+        // keepSorted=false defers the sorted copy to resort() (bulk loading)
+        void add(double s, bool keepSorted = true) {
+            if (count++ == 0 || s > best) best = s;
+            sum += s;
+            double old = 0;
+            bool full = recent.size() == WINDOW;
+            if (!full) recent.push_back(s);
+            else {
+                old = recent[head];
+                recent[head] = s;
+                head = (head + 1) % WINDOW;
+            }
+            if (!keepSorted) return;
+            if (full) sorted.erase(std::lower_bound(sorted.begin(), sorted.end(), old));
+            sorted.insert(std::upper_bound(sorted.begin(), sorted.end(), s), s);
         }
-        if (timeRem > 0) {
-            timeRem = (d > timeRem ? 0 : timeRem - d);
-            if (timeRem == 0) running = false;
+        void resort() {
+            sorted = recent;
+            std::sort(sorted.begin(), sorted.end());
         }
-    }
+        double mean() const { return count ? sum / count : 0; }
+        // nearest-rank percentile (0..1) over the last WINDOW sessions
+        double percentile(double p) const {
+            if (sorted.empty()) return 0;
+            size_t i = size_t(p * sorted.size());
+            return sorted[std::min(i, sorted.size() - 1)];
+        }
+    };
+    Stats stats[MODE_COUNT];
+    SessionAnalytics analytics[MODE_COUNT];
 
-    void render(SDL_Renderer* ren, double cy, double cp) {
-        SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
-        SDL_RenderClear(ren);
-        if (countdown > 0) {
-            int sec = (countdown + 500) / 1000;
-            char buf[8];sprintf(buf, "%d", sec);
-            SDL_SetRenderScale(ren, 4.0f, 4.0f);
-            SDL_RenderDebugText(ren,
-                WINDOW_WIDTH / 8 - 4, WINDOW_HEIGHT / 8 - 8, buf);
-            SDL_SetRenderScale(ren, 1.0f, 1.0f);
-            return;
+    ~ScoreLog() { close(); }
+
+    // Reads the history into stats and positions for appending. A torn
+    // trailing record (crash mid-append) is overwritten by the next one.
+    bool open(const char* path) {
+        close();
+        for (Stats& s : stats) s = Stats();
+        for (SessionAnalytics& a : analytics) a = SessionAnalytics();
+        file = fopen(path, "r+b");
+        if (!file) {
+            file = fopen(path, "w+b");
+            if (!file) return false;
+            Uint32 version = VERSION;
+            fwrite("AIMS", 1, 4, file);
+            fwrite(&version, sizeof(version), 1, file);
+            fflush(file);
+            return true;
         }
-        double hF = config.fov, asp = double(WINDOW_WIDTH) / WINDOW_HEIGHT;
-        double vF = (180.0 / M_PI) * 2 * atan(
-            tan(hF * M_PI / 180.0 / 2) * (1.0 / asp));
-        int boxRad = challengeMode
-            ? (targPixRad / 2)
-            : targPixRad;
-        for (int i = 0;i < 9;++i) {
-            if (!t[i].active) continue;
-            double dy = t[i].yaw - cy;
-            if (dy > 180) dy -= 360; else if (dy < -180) dy += 360;
-            double dp = t[i].pitch - cp;
-            if (fabs(dy) > hF / 2 + 5 || fabs(dp) > vF / 2 + 5) continue;
-            double xN = tan(dy * M_PI / 180.0) / tan(hF * M_PI / 180.0 / 2);
-            double yN = tan(dp * M_PI / 180.0) / tan(vF * M_PI / 180.0 / 2);
-            int x = int(xN * (WINDOW_WIDTH / 2) + WINDOW_WIDTH / 2);
-            int y = int(-yN * (WINDOW_HEIGHT / 2) + WINDOW_HEIGHT / 2);
-            drawRect(ren,
-                x - boxRad, y - boxRad,
-                2 * boxRad, 2 * boxRad,
-                tgtCol);
+        char magic[4];
+        Uint32 version = 0;
+        if (fread(magic, 1, 4, file) != 4 || memcmp(magic, "AIMS", 4) != 0 ||
+            fread(&version, sizeof(version), 1, file) != 1 || version != VERSION) {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,
+                "%s is not a score log, scores will not be saved", path);
+            close();
+            return false;
+        }
+        std::vector<Record> chunk(4096);
+        size_t n;
+        long end = 8;
+        while ((n = fread(chunk.data(), sizeof(Record), chunk.size(), file)) > 0) {
+            for (size_t i = 0; i < n; ++i)
+                if (chunk[i].mode < MODE_COUNT && !chunk[i].custom) {
+                    stats[chunk[i].mode].add(chunk[i].score, false);
+                    analytics[chunk[i].mode].add(chunk[i].score, chunk[i].sensitivity, chunk[i].fov);
+                }
+            end += long(n * sizeof(Record));
         }
-        // crosshair
-        SDL_Color cc{ (Uint8)config.cross_r,
-                     (Uint8)config.cross_g,
-                     (Uint8)config.cross_b,255 };
-        int gap = config.cross_gap, len = config.cross_len;
-        drawLine(ren,
-            WINDOW_WIDTH / 2 - len, WINDOW_HEIGHT / 2,
-            WINDOW_WIDTH / 2 - gap, WINDOW_HEIGHT / 2, cc);
-        drawLine(ren,
-            WINDOW_WIDTH / 2 + gap, WINDOW_HEIGHT / 2,
-            WINDOW_WIDTH / 2 + len, WINDOW_HEIGHT / 2, cc);
-        drawLine(ren,
-            WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2 - len,
-            WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2 - gap, cc);
-        drawLine(ren,
-            WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2 + gap,
-            WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2 + len, cc);
+        for (Stats& s : stats) s.resort();
+        fseek(file, end, SEEK_SET);
+        return true;
+    }
+    void close() {
+        if (file) fclose(file);
+        file = nullptr;
+    }
+    bool isOpen() const { return file != nullptr; }
 
-        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
-        char hud[64];
-        sprintf(hud, "Score:%d Streak:%d Time:%ds",
-            score, streak, timeRem / 1000);
-        SDL_RenderDebugText(ren, 10, 10, hud);
-        if (challengeMode)
-            SDL_RenderDebugText(ren, 10, 30, "CHALLENGE MODE");
+    // add() updates the aggregates, write()/flush() the file; the game
+    // hands those two to PersistWriter. append() does all of it inline.
+    void add(const Record& r) {
+        if (r.mode >= MODE_COUNT || r.custom) return;
+        stats[r.mode].add(r.score);
+        analytics[r.mode].add(r.score, r.sensitivity, r.fov);
+    }
+    bool write(const Record& r) {
+        return file && r.mode < MODE_COUNT && fwrite(&r, sizeof(r), 1, file) == 1;
+    }
+    bool flush(bool durable) {
+        if (!file) return false;
+        return durable ? syncFile(file) : fflush(file) == 0;
+    }
+    bool append(const Record& r) {
+        add(r);
+        return write(r) && flush(false);
+    }
+    // a record for a session just played with the current config; drill is
+    // the Scenario id of a custom drill, 0 for the classic modes
+    static Record make(Uint8 mode, bool challenge, double score, Uint64 drill = 0) {
+        Record r{};
+        r.time = Sint64(::time(nullptr));
+        r.score = score;
+        r.sensitivity = config.sensitivity;
+        r.fov = config.fov;
+        r.settingsHash = settingsHash(config, challenge, drill);
+        r.mode = mode;
+        r.challenge = challenge;
+        r.custom = drill != 0;
+        return r;
+    }
+    // FNV-1a over the settings that change what a score means
+    static Uint32 settingsHash(const GameConfig& cfg, bool challenge, Uint64 drill = 0) {
+        char key[96];
+        sprintf(key, "%.4f|%.2f|%d|%d", cfg.sensitivity, cfg.fov, int(challenge), cfg.tickRate);
+        if (drill) sprintf(key + strlen(key), "|%016llx", (unsigned long long)drill);
+        Uint32 h = 2166136261u;
+        for (const char* s = key; *s; ++s) h = (h ^ Uint8(*s)) * 16777619u;
+        return h;
     }
 
-    void toggleChallengeMode() override {
-        challengeMode = !challengeMode;
+    // Moves the score arrays older versions kept in the JSON file into the
+    // log. Only done into an empty log; either way the arrays are dropped.
+    bool migrate(GameConfig& cfg) {
+        std::vector<double>* legacy[MODE_COUNT] = {
+            &cfg.gridshotScores, &cfg.trackingScores, &cfg.swarmScores };
+        bool had = false, empty = true;
+        for (int m = 0; m < MODE_COUNT; ++m) {
+            had |= !legacy[m]->empty();
+            empty &= stats[m].count == 0;
+        }
+        if (!had) return false;
+        for (int m = 0; m < MODE_COUNT && empty; ++m)
+            for (double s : *legacy[m]) {
+                Record r = make(Uint8(m), false, s);
+                r.time = 0;
+                append(r);
+            }
+        for (std::vector<double>* v : legacy) std::vector<double>().swap(*v);
+        return true;
     }
+private:
+    FILE* file = nullptr;
 };
+static ScoreLog scoreLog;
 
-// --- TrackingMode (unchanged except inherits challengeMode) ---
-class TrackingMode : public GameMode {
-    double yaw = 0, pitch = 0, yv = 20, pv = 15;
-    double score = 0, streak = 0, best = 0;
-    Uint32 timeRem = 0, countdown = 0;
-    bool running = false, challengeMode = false;
-    SDL_Color tgtCol{ 200,50,200,255 };
+// --- Background persistence ---
+// All disk writes during play happen on this thread. Config saves are
+// snapshots and coalesce (only the newest pending one is written); score
+// records and whole-file writes (replays) queue in order; records are
+// fsynced per batch. stop() drains what is pending, so quitting never drops
+// a save. Without a thread (start() not called or failed) every call
+// writes synchronously.
+class PersistWriter {
 public:
-    double targAngRad = 3.0;
-    int    targPixRad = 20;
-    bool isInCountdown()const { return countdown > 0; }
-    bool isRunning()    const { return running; }
-    double getScore()   const { return score; }
-    void start() override {
-        score = streak = best = 0;
-        timeRem = GAME_DURATION_MS;
-        countdown = COUNTDOWN_DURATION_MS;
-        running = true;
-        yaw = pitch = 0;
-        yv = 20 * ((rand() % 2) ? 1 : -1);
-        pv = 15 * ((rand() % 2) ? 1 : -1);
+    bool start() {
+        lock = SDL_CreateMutex();
+        wake = SDL_CreateCondition();
+        if (lock && wake) thread = SDL_CreateThread(run, "persist", this);
+        if (!thread)
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,
+                "Persistence thread unavailable, saving synchronously: %s", SDL_GetError());
+        return thread != nullptr;
     }
-    void update(Uint32 d, double cy, double cp) {
-        if (!running) return;
-        if (countdown > 0) {
-            countdown = (d > countdown ? 0 : countdown - d);
-            return;
-        }
-        double dt = d / 1000.0;
-        double factor = challengeMode ? 2.0 : 1.0;
-        yaw += yv * factor * dt;
-        pitch += pv * factor * dt;
-        double hF = config.fov, asp = double(WINDOW_WIDTH) / WINDOW_HEIGHT;
-        double vF = (180.0 / M_PI) * 2 * atan(
-            tan(hF * M_PI / 180.0 / 2) * (1.0 / asp));
-        double maxY = hF / 2 - 5, maxP = vF / 2 - 5;
-        if (yaw < -maxY) { yaw = -maxY; yv = -yv; }
-        if (yaw > maxY) { yaw = maxY; yv = -yv; }
-        if (pitch < -maxP) { pitch = -maxP; pv = -pv; }
-        if (pitch > maxP) { pitch = maxP; pv = -pv; }
-        double dy = yaw - cy; if (dy > 180) dy -= 360; else if (dy < -180) dy += 360;
-        double dp = pitch - cp;
-        bool on = fabs(dy) <= targAngRad && fabs(dp) <= targAngRad;
-        if (on) {
-            score += dt * factor;
-            streak += dt * factor;
-            if (streak > best) best = streak;
-        }
-        else streak = 0;
-        if (timeRem > 0) {
-            timeRem = (d > timeRem ? 0 : timeRem - d);
-            if (timeRem == 0) running = false;
+    void saveConfig(const GameConfig& cfg) {
+        if (!thread) { report(JSONStorage::saveConfig(cfg), DATA_FILE); return; }
+        SDL_LockMutex(lock);
+        pendingConfig = cfg;
+        hasConfig = true;
+        SDL_SignalCondition(wake);
+        SDL_UnlockMutex(lock);
+    }
+    void appendScore(const ScoreLog::Record& r) {
+        if (!thread) { report(scoreLog.write(r) && scoreLog.flush(true), SCORE_LOG); return; }
+        SDL_LockMutex(lock);
+        records.push_back(r);
+        SDL_SignalCondition(wake);
+        SDL_UnlockMutex(lock);
+    }
+    void writeFile(std::string path, std::vector<Uint8> data) {
+        if (!thread) { report(writeFileAtomic(path.c_str(), data.data(), data.size()), path.c_str()); return; }
+        SDL_LockMutex(lock);
+        files.push_back({ std::move(path), std::move(data) });
+        SDL_SignalCondition(wake);
+        SDL_UnlockMutex(lock);
+    }
+    void stop() {
+        if (thread) {
+            SDL_LockMutex(lock);
+            quit = true;
+            SDL_SignalCondition(wake);
+            SDL_UnlockMutex(lock);
+            SDL_WaitThread(thread, nullptr);
+            thread = nullptr;
         }
+        if (wake) SDL_DestroyCondition(wake);
+        if (lock) SDL_DestroyMutex(lock);
+        wake = nullptr;
+        lock = nullptr;
     }
-    void render(SDL_Renderer* ren, double cy, double cp) {
-        SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
-        SDL_RenderClear(ren);
-        if (countdown > 0) {
-            int sec = (countdown + 500) / 1000;
+private:
+    SDL_Thread* thread = nullptr;
+    SDL_Mutex* lock = nullptr;
+    SDL_Condition* wake = nullptr;
+    // guarded by lock
+    GameConfig pendingConfig{};
+    bool hasConfig = false, quit = false;
+    std::vector<ScoreLog::Record> records;
+    struct FileJob { std::string path; std::vector<Uint8> data; };
+    std::vector<FileJob> files;
+
+    static void report(bool ok, const char* path) {
+        if (!ok) SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Could not write %s", path);
+    }
+    static int SDLCALL run(void* self) {
+        static_cast<PersistWriter*>(self)->loop();
+        return 0;
+    }
+    void loop() {
+        Trace::nameThread("persist");
+        GameConfig cfg{};
+        std::vector<ScoreLog::Record> batch;
+        std::vector<FileJob> jobs;
+        SDL_LockMutex(lock);
+        for (;;) {
+            while (!quit && !hasConfig && records.empty() && files.empty())
+                SDL_WaitCondition(wake, lock);
+            bool save = hasConfig;
+            if (save) cfg = pendingConfig;
+            hasConfig = false;
+            batch.swap(records);
+            jobs.swap(files);
+            bool done = quit && !save && batch.empty() && jobs.empty();
+            SDL_UnlockMutex(lock);
+            if (done) return;
+            if (!batch.empty()) {
+                bool ok = true;
+                for (const ScoreLog::Record& r : batch) ok &= scoreLog.write(r);
+                report(scoreLog.flush(true) && ok, SCORE_LOG);
+                batch.clear();
+            }
+            if (save) report(JSONStorage::saveConfig(cfg), DATA_FILE);
+            for (const FileJob& j : jobs)
+                report(writeFileAtomic(j.path.c_str(), j.data.data(), j.data.size()), j.path.c_str());
+            jobs.clear();
+            SDL_LockMutex(lock);
+        }
+    }
+};
+static PersistWriter persist;
+
+// --- Scenarios ---
+// Custom drills are JSON files in scenarios/. "mode" is required; every
+// other key (FIELDS, plus "name" and "pattern") overrides the built-in
+// drill of that mode, and challengeTargets follows targets unless given:
+//   { "name": "Micro flicks", "mode": "gridshot", "durationMs": 30000,
+//     "gridCols": 5, "gridRows": 4, "span": 24, "size": 1.2, "targets": 3 }
+// Library::load compiles each file into a validated Scenario and keeps the
+// results in SCENARIO_CACHE, keyed by a hash of the file name and contents.
+// Later loads read and hash the files but parse only new or edited ones;
+// choosing a drill then only copies a Scenario into its mode.
+namespace Scenarios {
+    static const Uint8 CACHE_VERSION = 1;   // bump with Scenario's layout or the built-in defaults
+
+    struct Field {
+        std::string_view key;
+        double lo, hi;
+        int   Scenario::* i = nullptr;
+        double Scenario::* f = nullptr;
+        Field(std::string_view k, double l, double h, int Scenario::* p) : key(k), lo(l), hi(h), i(p) {}
+        Field(std::string_view k, double l, double h, double Scenario::* p) : key(k), lo(l), hi(h), f(p) {}
+    };
+    static const Field FIELDS[] = {
+        { "durationMs",       1000, 3600000,  &Scenario::durationMs },
+        { "countdownMs",      0,    10000,    &Scenario::countdownMs },
+        { "targets",          1,    MAX_SWARM_TARGETS, &Scenario::targets },
+        { "challengeTargets", 1,    MAX_SWARM_TARGETS, &Scenario::challengeTargets },
+        { "gridCols",         1,    MAX_GRID, &Scenario::gridCols },
+        { "gridRows",         1,    MAX_GRID, &Scenario::gridRows },
+        { "hitScore",         0,    1000,     &Scenario::hitScore },
+        { "missPenalty",      0,    1000,     &Scenario::missPenalty },
+        { "span",             0,    170,      &Scenario::span },
+        { "size",             0.05, 45,       &Scenario::size },
+        { "maxSize",          0.05, 45,       &Scenario::maxSize },
+        { "drawSize",         1,    200,      &Scenario::drawSize },
+        { "speed",            0,    720,      &Scenario::speed },
+        { "fieldYaw",         1,    180,      &Scenario::fieldYaw },
+        { "fieldPitch",       1,    89,       &Scenario::fieldPitch },
+        { "challenge",        0.1,  10,       &Scenario::challenge },
+    };
+    static const int FIELD_COUNT = int(sizeof(FIELDS) / sizeof(FIELDS[0]));
+    static int fieldIndex(std::string_view key) {
+        for (int k = 0; k < FIELD_COUNT; ++k) if (FIELDS[k].key == key) return k;
+        return -1;
+    }
+
+    // Range and cross-field checks; field names the offending key. Also
+    // guards records read back from the cache or a replay.
+    static const char* validate(const Scenario& s, std::string_view* field = nullptr) {
+        if (s.mode < 0 || s.mode >= MODE_COUNT) return "unknown mode";
+        if (s.pattern < 0 || s.pattern >= MOTION_COUNT) return "unknown pattern";
+        if (!memchr(s.name, 0, sizeof(s.name))) return "bad name";
+        for (const Field& fd : FIELDS) {
+            double v = fd.i ? double(s.*fd.i) : s.*fd.f;
+            if (!(v >= fd.lo && v <= fd.hi)) {
+                if (field) *field = fd.key;
+                return "value out of range";
+            }
+        }
+        int most = s.mode == MODE_GRIDSHOT ? s.gridCols * s.gridRows
+            : s.mode == MODE_TRACKING ? MAX_TRACK_TARGETS : MAX_SWARM_TARGETS;
+        if (field) *field = "targets";
+        if (s.targets > most || s.challengeTargets > most) return "more than the drill can hold";
+        if (field) *field = "size";
+        if (s.size > s.maxSize) return "above maxSize";
+        return nullptr;
+    }
+
+    // the classic drill of a mode; tracking takes its motion from Settings
+    static Scenario classic(int mode) {
+        Scenario s = Scenario::builtin(mode);
+        if (mode == MODE_TRACKING) {
+            s.pattern = CLAMP(config.trackPattern, 0, MOTION_COUNT - 1);
+            s.targets = s.challengeTargets = CLAMP(config.trackTargets, 1, MAX_TRACK_TARGETS);
+        }
+        return s;
+    }
+
+    // Parses and validates one drill file; "name" defaults to stem. On
+    // failure why holds the reason (and byte offset for syntax errors).
+    static bool compile(std::string_view text, const char* stem, Scenario& out, char* why, size_t whySize) {
+        JSONStorage::Parser parser(text);
+        Scenario v;
+        memset(&v, 0, sizeof(v));
+        Uint32 given = 0;
+        int mode = -1, pattern = -1;
+        std::string_view name = stem;
+        bool ok = parser.object([&](std::string_view key) {
+            std::string_view word;
+            if (key == "name") return parser.string(name);
+            if (key == "mode" || key == "pattern") {
+                if (!parser.string(word)) return false;
+                bool isMode = key == "mode";
+                int& dst = isMode ? mode : pattern;
+                dst = -1;
+                int count = isMode ? int(MODE_COUNT) : int(MOTION_COUNT);
+                for (int k = 0; k < count; ++k)
+                    if (word == (isMode ? MODE_NAMES[k] : MOTION_NAMES[k])) dst = k;
+                return dst >= 0 || parser.fail(isMode ? "unknown mode" : "unknown pattern");
+            }
+            int k = fieldIndex(key);
+            if (k < 0) return parser.fail("unknown key");
+            double d;
+            if (!parser.number(d)) return false;
+            if (d < FIELDS[k].lo || d > FIELDS[k].hi) return parser.fail("value out of range");
+            if (FIELDS[k].i) v.*FIELDS[k].i = int(d);
+            else v.*FIELDS[k].f = d;
+            given |= 1u << k;
+            return true;
+            });
+        if (!ok) {
+            snprintf(why, whySize, "byte %zu: %s", parser.errorPos, parser.error);
+            return false;
+        }
+        if (mode < 0) {
+            snprintf(why, whySize, "no \"mode\"");
+            return false;
+        }
+        out = Scenario::builtin(mode);
+        for (int k = 0; k < FIELD_COUNT; ++k) {
+            if (!(given & (1u << k))) continue;
+            if (FIELDS[k].i) out.*FIELDS[k].i = v.*FIELDS[k].i;
+            else out.*FIELDS[k].f = v.*FIELDS[k].f;
+        }
+        if (!(given & (1u << fieldIndex("challengeTargets")))) out.challengeTargets = out.targets;
+        if (!(given & (1u << fieldIndex("maxSize")))) out.maxSize = std::max(out.maxSize, out.size);
+        if (pattern >= 0) out.pattern = pattern;
+        size_t len = std::min(name.size(), sizeof(out.name) - 1);
+        memcpy(out.name, name.data(), len);
+        out.name[len] = 0;
+        std::string_view field = "drill";
+        const char* bad = validate(out, &field);
+        if (bad) snprintf(why, whySize, "%.*s: %s", int(field.size()), field.data(), bad);
+        return !bad;
+    }
+
+    // FNV-1a 64
+    static Uint64 hash(const void* data, size_t size, Uint64 h = 14695981039346656037ull) {
+        const Uint8* p = static_cast<const Uint8*>(data);
+        for (size_t i = 0; i < size; ++i) h = (h ^ p[i]) * 1099511628211ull;
+        return h;
+    }
+
+    class Library {
+    public:
+        std::vector<Scenario> drills;   // in file name order
+        int compiled = 0, cached = 0, rejected = 0;   // files, last load()
+
+        // Cache layout ("AIMC"): magic, version, sizeof(Scenario) (u16),
+        // count (u32), then the Scenario records, each keyed by its id.
+        void load(const char* dir = SCENARIO_DIR, const char* cachePath = SCENARIO_CACHE) {
+            drills.clear();
+            compiled = cached = rejected = 0;
+            std::unordered_map<Uint64, Scenario> cache;
+            readCache(cachePath, cache);
+            std::vector<std::string> files;
+            int count = 0;
+            char** names = SDL_GlobDirectory(dir, "*.json", 0, &count);
+            for (int i = 0; i < count; ++i) files.push_back(names[i]);
+            SDL_free(names);
+            std::sort(files.begin(), files.end());
+            std::string path, text;
+            char why[128];
+            for (const std::string& f : files) {
+                path = std::string(dir) + "/" + f;
+                if (!readFile(path.c_str(), text)) {
+                    SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Could not read %s", path.c_str());
+                    ++rejected;
+                    continue;
+                }
+                Uint64 id = hash(text.data(), text.size(), hash(f.c_str(), f.size() + 1));
+                auto it = cache.find(id);
+                if (it != cache.end()) {
+                    drills.push_back(it->second);
+                    ++cached;
+                    continue;
+                }
+                std::string stem = f.substr(0, f.size() - 5);
+                Scenario s;
+                if (!compile(text, stem.c_str(), s, why, sizeof(why))) {
+                    SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "%s: %s", path.c_str(), why);
+                    ++rejected;
+                    continue;
+                }
+                s.id = id;
+                drills.push_back(s);
+                ++compiled;
+            }
+            // rewrite when drills were compiled or cached ones went away
+            for (const Scenario& s : drills) cache.erase(s.id);
+            if (compiled || !cache.empty()) writeCache(cachePath);
+        }
+    private:
+        static void readCache(const char* path, std::unordered_map<Uint64, Scenario>& cache) {
+            std::string b;
+            if (!readFile(path, b) || b.size() < 11 || memcmp(b.data(), "AIMC", 4) != 0 ||
+                Uint8(b[4]) != CACHE_VERSION)
+                return;
+            Uint16 recSize;
+            Uint32 count;
+            memcpy(&recSize, &b[5], 2);
+            memcpy(&count, &b[7], 4);
+            if (recSize != sizeof(Scenario) || b.size() != 11 + size_t(count) * sizeof(Scenario))
+                return;
+            cache.reserve(count);
+            Scenario s;
+            for (Uint32 i = 0; i < count; ++i) {
+                memcpy(&s, &b[11 + size_t(i) * sizeof(Scenario)], sizeof(Scenario));
+                if (!validate(s)) cache.emplace(s.id, s);
+            }
+        }
+        void writeCache(const char* path) const {
+            std::vector<Uint8> b = { 'A','I','M','C', CACHE_VERSION };
+            std::vector<const Scenario*> unique;
+            for (const Scenario& s : drills) unique.push_back(&s);
+            std::sort(unique.begin(), unique.end(),
+                [](const Scenario* a, const Scenario* c) { return a->id < c->id; });
+            unique.erase(std::unique(unique.begin(), unique.end(),
+                [](const Scenario* a, const Scenario* c) { return a->id == c->id; }), unique.end());
+            Uint16 recSize = sizeof(Scenario);
+            Uint32 count = Uint32(unique.size());
+            const Uint8* p = reinterpret_cast<const Uint8*>(&recSize);
+            b.insert(b.end(), p, p + 2);
+            p = reinterpret_cast<const Uint8*>(&count);
+            b.insert(b.end(), p, p + 4);
+            for (const Scenario* s : unique) {
+                p = reinterpret_cast<const Uint8*>(s);
+                b.insert(b.end(), p, p + sizeof(Scenario));
+            }
+            persist.writeFile(path, std::move(b));
+        }
+    };
+}
+
+// --- Utility ---
+struct Rect { int x, y, w, h; };
+static bool pointInRect(int px, int py, const Rect& r) {
+    return px >= r.x && px <= r.x + r.w && py >= r.y && py <= r.y + r.h;
+}
+// relative mouse motion -> camera angles (degrees)
+static void applyMouseMotion(double& camYaw, double& camPitch, float xrel, float yrel, float sensitivity) {
+    camYaw += xrel * sensitivity;
+    camPitch -= yrel * sensitivity;
+    camPitch = CLAMP(camPitch, -89.0, 89.0);
+    if (camYaw < 0) camYaw += 360;
+    if (camYaw >= 360) camYaw -= 360;
+}
+
+// --- Draw batching ---
+// drawRect/drawLine only queue colored quads. Everything else that touches
+// the renderer (text, clear, scale/target changes, present) flushes first,
+// so submission order is preserved and a frame's primitives go out in as
+// few SDL_RenderGeometry calls as there are text/state breaks.
+class DrawBatch {
+    std::vector<SDL_Vertex> verts;
+    std::vector<int> idx;
+    SDL_Renderer* target = nullptr;
+    int calls = 0, prims = 0;
+public:
+    int lastDrawCalls = 0, lastPrimitives = 0;   // previous frame
+
+    void quad(SDL_Renderer* ren, const SDL_FPoint p[4], SDL_Color c) {
+        if (ren != target) { flush(); target = ren; }
+        SDL_FColor fc{ c.r / 255.f, c.g / 255.f, c.b / 255.f, c.a / 255.f };
+        int base = int(verts.size());
+        for (int i = 0;i < 4;++i) verts.push_back({ p[i], fc, { 0,0 } });
+        const int tri[6] = { 0,1,2, 0,2,3 };
+        for (int i = 0;i < 6;++i) idx.push_back(base + tri[i]);
+        prims++;
+    }
+    void rect(SDL_Renderer* ren, float x, float y, float w, float h, SDL_Color c) {
+        SDL_FPoint p[4] = { {x,y}, {x + w,y}, {x + w,y + h}, {x,y + h} };
+        quad(ren, p, c);
+    }
+    void flush() {
+        if (!target || idx.empty()) return;
+        SDL_RenderGeometry(target, nullptr, verts.data(), int(verts.size()),
+            idx.data(), int(idx.size()));
+        calls++;
+        verts.clear();
+        idx.clear();
+    }
+    // count an immediate (unbatched) renderer call
+    void direct() { calls++; }
+    void discard() { verts.clear(); idx.clear(); }
+    void endFrame() {
+        flush();
+        lastDrawCalls = calls;
+        lastPrimitives = prims;
+        calls = prims = 0;
+    }
+};
+static DrawBatch batch;
+
+static void drawRect(SDL_Renderer* ren, int x, int y, int w, int h, SDL_Color c) {
+    batch.rect(ren, float(x), float(y), float(w), float(h), c);
+}
+// 1px line; axis-aligned lines (all of ours) become exact pixel rects
+static void drawLine(SDL_Renderer* ren, int x1, int y1, int x2, int y2, SDL_Color c) {
+    if (y1 == y2)
+        batch.rect(ren, float(std::min(x1, x2)), float(y1), float(abs(x2 - x1) + 1), 1.f, c);
+    else if (x1 == x2)
+        batch.rect(ren, float(x1), float(std::min(y1, y2)), 1.f, float(abs(y2 - y1) + 1), c);
+    else {
+        float dx = float(x2 - x1), dy = float(y2 - y1);
+        float l = sqrtf(dx * dx + dy * dy);
+        float nx = -dy / l * 0.5f, ny = dx / l * 0.5f;
+        SDL_FPoint p[4] = {
+            { x1 + 0.5f + nx, y1 + 0.5f + ny }, { x2 + 0.5f + nx, y2 + 0.5f + ny },
+            { x2 + 0.5f - nx, y2 + 0.5f - ny }, { x1 + 0.5f - nx, y1 + 0.5f - ny } };
+        batch.quad(ren, p, c);
+    }
+}
+
+// --- Text cache ---
+// Each distinct string is rasterized once into a small target texture and
+// re-blitted (one copy instead of one per glyph) until it falls out of use.
+// Textures are tinted with the current draw color, like SDL_RenderDebugText.
+// Call clear() before the renderer is destroyed or its targets are reset.
+class TextCache {
+    struct Entry {
+        std::string text;
+        SDL_Texture* tex;
+        float w, h;
+        Uint32 lastUsed;
+    };
+    std::unordered_map<Uint64, Entry> entries;
+    SDL_Renderer* owner = nullptr;
+    Uint32 frame = 0;
+    static const size_t MAX_ENTRIES = 512;
+    static const Uint32 MAX_IDLE_FRAMES = 300;
+
+    static Uint64 hash(const char* s) {
+        Uint64 h = 1469598103934665603ull;
+        for (;*s;++s) h = (h ^ Uint8(*s)) * 1099511628211ull;
+        return h;
+    }
+    static SDL_Texture* build(SDL_Renderer* ren, const char* s, float& w, float& h) {
+        w = float(strlen(s) * SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE);
+        h = float(SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE);
+        SDL_Texture* t = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA8888,
+            SDL_TEXTUREACCESS_TARGET, int(w), int(h));
+        if (!t) return nullptr;
+        SDL_SetTextureBlendMode(t, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureScaleMode(t, SDL_SCALEMODE_NEAREST);
+        Uint8 r, g, b, a;
+        SDL_GetRenderDrawColor(ren, &r, &g, &b, &a);
+        SDL_Texture* prev = SDL_GetRenderTarget(ren);
+        SDL_SetRenderTarget(ren, t);
+        SDL_SetRenderDrawColor(ren, 0, 0, 0, 0);
+        SDL_RenderClear(ren);
+        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
+        SDL_RenderDebugText(ren, 0, 0, s);
+        SDL_SetRenderTarget(ren, prev);
+        SDL_SetRenderDrawColor(ren, r, g, b, a);
+        return t;
+    }
+public:
+    // false if the string could not be cached (caller draws it directly)
+    bool draw(SDL_Renderer* ren, float x, float y, const char* s) {
+        if (!*s) return true;
+        if (ren != owner) { clear(); owner = ren; }
+        Uint64 key = hash(s);
+        auto it = entries.find(key);
+        if (it == entries.end() || it->second.text != s) {
+            if (it != entries.end()) {
+                SDL_DestroyTexture(it->second.tex);
+                entries.erase(it);
+            }
+            if (entries.size() >= MAX_ENTRIES) evict(0);
+            Entry e{ s, nullptr, 0, 0, frame };
+            e.tex = build(ren, s, e.w, e.h);
+            if (!e.tex) return false;
+            it = entries.emplace(key, e).first;
+        }
+        Entry& e = it->second;
+        e.lastUsed = frame;
+        Uint8 r, g, b, a;
+        SDL_GetRenderDrawColor(ren, &r, &g, &b, &a);
+        SDL_SetTextureColorMod(e.tex, r, g, b);
+        SDL_FRect dst{ x, y, e.w, e.h };
+        SDL_RenderTexture(ren, e.tex, nullptr, &dst);
+        return true;
+    }
+    // drop entries idle for more than maxIdle frames
+    void evict(Uint32 maxIdle) {
+        for (auto it = entries.begin();it != entries.end();) {
+            if (frame - it->second.lastUsed > maxIdle) {
+                SDL_DestroyTexture(it->second.tex);
+                it = entries.erase(it);
+            }
+            else ++it;
+        }
+    }
+    void endFrame() {
+        if (++frame % 64 == 0) evict(MAX_IDLE_FRAMES);
+    }
+    void clear() {
+        for (auto& kv : entries) SDL_DestroyTexture(kv.second.tex);
+        entries.clear();
+    }
+};
+static TextCache textCache;
+
+static void drawText(SDL_Renderer* ren, float x, float y, const char* str) {
+    batch.flush();
+    if (!textCache.draw(ren, x, y, str))
+        SDL_RenderDebugText(ren, x, y, str);
+    batch.direct();
+}
+static void clearScreen(SDL_Renderer* ren) {
+    batch.discard();
+    SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
+    SDL_RenderClear(ren);
+    batch.direct();
+}
+static void setRenderScale(SDL_Renderer* ren, float sx, float sy) {
+    batch.flush();
+    SDL_SetRenderScale(ren, sx, sy);
+}
+// every screen picks its space at the top of render(): UI units (times k)
+// for menus and text, pixels for the 3D view
+static void uiScale(SDL_Renderer* ren, float k = 1.0f) {
+    setRenderScale(ren, view.scale * k, view.scale * k);
+}
+static void pixelScale(SDL_Renderer* ren) {
+    setRenderScale(ren, 1.0f, 1.0f);
+}
+
+
+// Brings the live context up to date with config and the window.
+static void syncLiveContext() {
+    liveContext.sensitivity = config.sensitivity;
+    liveContext.fov = config.fov;
+    liveContext.viewW = view.w;
+    liveContext.viewH = view.h;
+    liveContext.sync();
+}
+
+// Re-reads the output size and display scale; false if nothing changed, so
+// the caller only rebuilds layouts on a real change. The UI scale follows
+// the display but shrinks if the menus would no longer fit.
+static bool syncView(SDL_Window* win, SDL_Renderer* ren) {
+    int w = 0, h = 0;
+    if (!SDL_GetRenderOutputSize(ren, &w, &h) || w <= 0 || h <= 0) return false;
+    float density = SDL_GetWindowPixelDensity(win);
+    float scale = SDL_GetWindowDisplayScale(win);   // density times content scale
+    if (density <= 0) density = 1.0f;
+    scale = std::min({ scale, float(w) / MIN_UI_WIDTH, float(h) / MIN_UI_HEIGHT });
+    if (scale < 1.0f) scale = 1.0f;
+    if (w == view.w && h == view.h && density == view.density && scale == view.scale)
+        return false;
+    view.w = w; view.h = h;
+    view.density = density;
+    view.scale = scale;
+    syncLiveContext();
+    // keep the window large enough for the menus at this scale
+    SDL_SetWindowMinimumSize(win, int(MIN_UI_WIDTH * scale / density),
+        int(MIN_UI_HEIGHT * scale / density));
+    return true;
+}
+
+// Crosshair at the view center, in pixels; gap, length and thickness
+// follow the UI scale so it looks the same size on any display.
+static void drawCrosshair(SDL_Renderer* ren) {
+    SDL_Color cc{ (Uint8)config.cross_r,
+                 (Uint8)config.cross_g,
+                 (Uint8)config.cross_b,255 };
+    int cx = view.w / 2, cy = view.h / 2;
+    int gap = int(config.cross_gap * view.scale), len = int(config.cross_len * view.scale);
+    int t = std::max(1, int(view.scale + 0.5f)), o = t / 2;
+    drawRect(ren, cx - len, cy - o, len - gap + 1, t, cc);
+    drawRect(ren, cx + gap, cy - o, len - gap + 1, t, cc);
+    drawRect(ren, cx - o, cy - len, t, len - gap + 1, cc);
+    drawRect(ren, cx - o, cy + gap, t, len - gap + 1, cc);
+}
+
+// --- Fixed-timestep clock ---
+// Accumulates SDL_GetTicksNS() time and hands it out as whole simulation
+// ticks, so game time never depends on how long a frame took.
+struct FixedStepClock {
+    Uint64 tickNS = SDL_NS_PER_SECOND / 1000;
+    Uint64 prevNS = 0, accumNS = 0;
+    Uint64 tickWallNS = 0;        // wall-clock end of the last tick handed out
+    Uint32 maxCatchUp = 250;      // ticks per frame before we drop time
+    Uint64 droppedTicks = 0;
+
+    void setRate(int hz) {
+        hz = CLAMP(hz, 30, 8000);
+        tickNS = SDL_NS_PER_SECOND / Uint64(hz);
+    }
+    void reset(Uint64 now) {
+        prevNS = now;
+        tickWallNS = now;
+        accumNS = 0;
+        droppedTicks = 0;
+    }
+    // Number of ticks due since the last call.
+    Uint32 advance(Uint64 now) {
+        accumNS += now - prevNS;
+        prevNS = now;
+        Uint64 n = accumNS / tickNS;
+        if (n > maxCatchUp) {
+            Uint64 drop = n - maxCatchUp;
+            droppedTicks += drop;
+            accumNS -= drop * tickNS;
+            tickWallNS += drop * tickNS;
+            n = maxCatchUp;
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,
+                "Simulation fell behind: dropped %llu ticks (%llu total)",
+                (unsigned long long)drop, (unsigned long long)droppedTicks);
+        }
+        accumNS -= n * tickNS;
+        return Uint32(n);
+    }
+    // Wall-clock time at which the next of this frame's ticks ends; input
+    // stamped up to then belongs to that tick.
+    Uint64 nextTick() { return tickWallNS += tickNS; }
+};
+
+// --- Frame pacer ---
+// Waits out the rest of each frame: sleeps until just before the deadline,
+// then spins the remainder. The sleep slack is calibrated at startup from
+// the measured SDL_DelayNS overshoot and widened if the OS oversleeps.
+class FramePacer {
+    Uint64 deadline = 0;
+    Uint64 slackNS = 2000000;
+    int mode = PACE_CAPPED, cap = 240;
+    bool vsyncActive = false;
+    Uint64 refreshNS = 0;   // display refresh period, 0 if unknown
+
+    void sleepUntil(Uint64 target) {
+        Uint64 now = SDL_GetTicksNS();
+        if (target > now + slackNS) {
+            Uint64 want = target - now - slackNS;
+            SDL_DelayNS(want);
+            Uint64 slept = SDL_GetTicksNS() - now;
+            // oversleeping into the deadline: widen slack for next time
+            if (slept > want + slackNS) slackNS = CLAMP(slept - want + 250000, 250000ull, 4000000ull);
+        }
+        while (SDL_GetTicksNS() < target) {}
+    }
+public:
+    void calibrate() {
+        Uint64 worst = 0;
+        for (int i = 0;i < 8;++i) {
+            Uint64 t0 = SDL_GetTicksNS();
+            SDL_DelayNS(1000000);
+            Uint64 over = SDL_GetTicksNS() - t0 - 1000000;
+            if (over > worst) worst = over;
+        }
+        slackNS = CLAMP(worst + 250000, 250000ull, 4000000ull);
+    }
+
+    void apply(SDL_Renderer* ren, int pacingMode, int fpsCap) {
+        mode = CLAMP(pacingMode, 0, PACE_COUNT - 1);
+        cap = CLAMP(fpsCap, MIN_FPS_CAP, MAX_FPS_CAP);
+        vsyncActive = false;
+        if (mode == PACE_VSYNC)
+            vsyncActive = SDL_SetRenderVSync(ren, 1);
+        else if (mode == PACE_ADAPTIVE)
+            // late frames tear instead of waiting a whole refresh; without
+            // driver support fall back to the FPS cap
+            vsyncActive = SDL_SetRenderVSync(ren, SDL_RENDERER_VSYNC_ADAPTIVE);
+        if (!vsyncActive)
+            SDL_SetRenderVSync(ren, SDL_RENDERER_VSYNC_DISABLED);
+        deadline = 0;
+        refreshNS = 0;
+        SDL_Window* win = SDL_GetRenderWindow(ren);
+        const SDL_DisplayMode* dm = win ? SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(win)) : nullptr;
+        if (dm && dm->refresh_rate > 0) refreshNS = Uint64(SDL_NS_PER_SECOND / dm->refresh_rate);
+    }
+
+    bool vsync() const { return vsyncActive; }
+    // frame time a session should fit in: one refresh under vsync,
+    // otherwise the FPS cap (which is also the target when uncapped)
+    Uint64 budgetNS() const {
+        if (vsyncActive && refreshNS) return refreshNS;
+        return SDL_NS_PER_SECOND / Uint64(cap);
+    }
+
+    // Call once per frame after SDL_RenderPresent.
+    void wait(bool inMenu) {
+        int fps = 0;
+        if (!vsyncActive) {
+            if (mode != PACE_UNCAPPED) fps = cap;
+            if (inMenu && (fps == 0 || fps > MENU_FPS_CAP)) fps = MENU_FPS_CAP;
+        }
+        if (fps == 0) { deadline = 0; return; }
+        Uint64 period = SDL_NS_PER_SECOND / Uint64(fps);
+        Uint64 now = SDL_GetTicksNS();
+        // missed by more than a frame: resync instead of bursting
+        if (deadline == 0 || now > deadline + period) deadline = now;
+        deadline += period;
+        sleepUntil(deadline);
+    }
+};
+
+// --- Resolution governor ---
+// Game scenes are drawn into an offscreen target at scale x the output size
+// and stretched onto the window; the crosshair and HUD are drawn after that
+// at native resolution. update() steers the scale from the measured frame
+// work against the pacer's budget: down quickly (cost goes roughly with
+// scale^2) when the average runs over, back up one step at a time after a
+// long stretch well under it. At full scale scenes go straight to the
+// window with no extra copy. Scales are quantized to STEP so the target
+// texture is only reallocated when the step changes.
+class ResolutionGovernor {
+    SDL_Texture* tex = nullptr;
+    int texW = 0, texH = 0;
+    bool active = false;   // inside beginScene/endScene on the offscreen target
+    bool drewScene = false;   // this frame had a scene (not a menu or countdown)
+    double avgNS = 0;
+    int sinceChange = 0;   // frames measured at the current scale
+public:
+    static constexpr float MIN_SCALE = 0.5f, STEP = 0.05f;
+    float scale = 1.0f;
+
+    // once per frame; workNS is the frame without pacing waits. Only frames
+    // that drew a scene count, menus and countdowns restart the average.
+    void update(Uint64 workNS, Uint64 budgetNS) {
+        bool measure = drewScene;
+        drewScene = false;
+        if (!config.dynamicResolution) scale = 1.0f;
+        if (!measure || !config.dynamicResolution || budgetNS == 0) {
+            avgNS = 0; sinceChange = 0;
+            return;
+        }
+        steer(workNS, budgetNS);
+    }
+    // the controller on its own, one measured scene frame per call
+    void steer(Uint64 workNS, Uint64 budgetNS) {
+        avgNS = avgNS == 0 ? double(workNS) : avgNS + (double(workNS) - avgNS) * 0.1;
+        ++sinceChange;
+        float next = scale;
+        if (avgNS > budgetNS * 0.9 && sinceChange >= 8) {
+            next = scale * float(sqrt(budgetNS * 0.8 / avgNS));
+            next = std::min(next, scale - STEP);
+        }
+        else if (avgNS < budgetNS * 0.6 && sinceChange >= 60)
+            next = scale + STEP;
+        next = CLAMP(roundf(next / STEP) * STEP, MIN_SCALE, 1.0f);
+        if (fabsf(next - scale) > STEP / 2) {
+            scale = next;
+            avgNS = 0; sinceChange = 0;
+        }
+    }
+
+    // replaces clearScreen() + pixelScale() at the top of a scene
+    void beginScene(SDL_Renderer* ren) {
+        active = false;
+        drewScene = true;
+        if (scale < 1.0f) {
+            int w = std::max(1, int(view.w * scale + 0.5f)), h = std::max(1, int(view.h * scale + 0.5f));
+            if (!tex || w != texW || h != texH) {
+                release();
+                tex = SDL_CreateTexture(ren, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, w, h);
+                if (tex) {
+                    SDL_SetTextureScaleMode(tex, SDL_SCALEMODE_LINEAR);
+                    texW = w; texH = h;
+                }
+            }
+            batch.flush();
+            active = tex && SDL_SetRenderTarget(ren, tex);
+        }
+        clearScreen(ren);
+        // scene coordinates stay in output pixels either way
+        if (active) setRenderScale(ren, float(texW) / view.w, float(texH) / view.h);
+        else pixelScale(ren);
+    }
+    // stretches the scene onto the window; draw the crosshair/HUD after this
+    void endScene(SDL_Renderer* ren) {
+        if (!active) return;
+        active = false;
+        batch.flush();
+        SDL_SetRenderTarget(ren, nullptr);
+        pixelScale(ren);
+        SDL_RenderTexture(ren, tex, nullptr, nullptr);
+        batch.direct();
+    }
+    void release() {
+        if (tex) SDL_DestroyTexture(tex);
+        tex = nullptr;
+        texW = texH = 0;
+    }
+};
+static ResolutionGovernor governor;
+
+// --- Performance HUD (F3) ---
+// Per-phase frame timings in a single-producer ring; the overlay reads a
+// consistent window by loading the write index with acquire ordering.
+struct FrameTiming {
+    Uint64 events, update, render, present, total;   // ns
+    int drawCalls, primitives;
+    float sceneScale;   // ResolutionGovernor::scale
+};
+
+class PerfHUD {
+    static const Uint32 CAPACITY = 256;   // power of two
+    FrameTiming ring[CAPACITY] = {};
+    std::atomic<Uint32> head{ 0 };
+public:
+    bool visible = false;
+
+    void push(const FrameTiming& t) {
+        Uint32 h = head.load(std::memory_order_relaxed);
+        ring[h & (CAPACITY - 1)] = t;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    void render(SDL_Renderer* ren) {
+        if (!visible) return;
+        Uint32 h = head.load(std::memory_order_acquire);
+        Uint32 n = h < CAPACITY ? h : CAPACITY;
+        if (n == 0) return;
+        uiScale(ren);
+        double totals[CAPACITY];
+        FrameTiming avg{};
+        for (Uint32 i = 0;i < n;++i) {
+            const FrameTiming& f = ring[(h - n + i) & (CAPACITY - 1)];
+            totals[i] = f.total / 1e6;
+            avg.events += f.events; avg.update += f.update;
+            avg.render += f.render; avg.present += f.present;
+        }
+        // graph: one bar per frame, 4 px per ms, 60/144 Hz reference lines
+        const int gw = int(CAPACITY), gh = 100;
+        int gx = view.uiW() - gw - 10, gy = 10;
+        drawRect(ren, gx - 5, gy - 5, gw + 10, gh + 72, { 20,20,20,255 });
+        for (Uint32 i = 0;i < n;++i) {
+            int bh = CLAMP(int(totals[i] * 4), 1, gh);
+            SDL_Color c = totals[i] > 1000.0 / 60 ? SDL_Color{ 220,60,60,255 }
+                : totals[i] > 1000.0 / 144 ? SDL_Color{ 220,200,60,255 }
+            : SDL_Color{ 60,200,60,255 };
+            drawRect(ren, gx + int(CAPACITY - n + i), gy + gh - bh, 1, bh, c);
+        }
+        drawLine(ren, gx, gy + gh - int(4000.0 / 60), gx + gw, gy + gh - int(4000.0 / 60),
+            { 160,160,160,255 });
+        drawLine(ren, gx, gy + gh - int(4000.0 / 144), gx + gw, gy + gh - int(4000.0 / 144),
+            { 90,90,90,255 });
+
+        std::sort(totals, totals + n);
+        auto pct = [&](double p) { return totals[Uint32(p * (n - 1) + 0.5)]; };
+        char buf[96];
+        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
+        sprintf(buf, "p50 %.2f p95 %.2f p99 %.2f", pct(0.50), pct(0.95), pct(0.99));
+        drawText(ren, float(gx), float(gy + gh + 6), buf);
+        sprintf(buf, "max %.2f ms  (%u frames)", totals[n - 1], n);
+        drawText(ren, float(gx), float(gy + gh + 18), buf);
+        sprintf(buf, "ev %.2f up %.2f rn %.2f pr %.2f",
+            avg.events / 1e6 / n, avg.update / 1e6 / n,
+            avg.render / 1e6 / n, avg.present / 1e6 / n);
+        drawText(ren, float(gx), float(gy + gh + 30), buf);
+        const FrameTiming& last = ring[(h - 1) & (CAPACITY - 1)];
+        sprintf(buf, "draw calls %d  prims %d  scene %d%%", last.drawCalls, last.primitives,
+            int(last.sceneScale * 100 + 0.5f));
+        drawText(ren, float(gx), float(gy + gh + 42), buf);
+    }
+};
+
+// --- Mouse input ring ---
+// Mouse events are captured by an SDL event watch the moment SDL queues
+// them, with SDL's nanosecond timestamps. Where SDL reads raw mouse input on
+// its own thread (Windows relative mode) the watch runs on that thread,
+// otherwise inside the event pump. Either way the simulation drains the
+// ring tick by tick in timestamp order instead of once per rendered frame.
+struct InputEvent {
+    Uint64 timeNS;     // SDL_GetTicksNS() clock
+    Uint32 type;       // SDL_EVENT_MOUSE_MOTION / _BUTTON_DOWN / _BUTTON_UP
+    float  x, y;       // window position (menus)
+    float  xrel, yrel; // relative motion (game modes)
+    Uint8  button;
+};
+
+class InputRing {
+    static const Uint32 CAPACITY = 8192;   // power of two, ~1 s at 8 kHz
+    InputEvent buf[CAPACITY];
+    alignas(64) std::atomic<Uint32> head{ 0 };   // next write, producer only
+    alignas(64) std::atomic<Uint32> tail{ 0 };   // next read, consumer only
+    // SDL may switch the delivering thread when relative mode toggles; the
+    // spinlock only orders producers, the consumer side never locks
+    SDL_SpinLock producerLock = 0;
+public:
+    std::atomic<Uint32> dropped{ 0 };
+
+    void push(const InputEvent& e) {
+        SDL_LockSpinlock(&producerLock);
+        Uint32 h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == CAPACITY) dropped++;
+        else {
+            buf[h & (CAPACITY - 1)] = e;
+            head.store(h + 1, std::memory_order_release);
+        }
+        SDL_UnlockSpinlock(&producerLock);
+    }
+    bool peek(InputEvent& e) const {
+        Uint32 t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        e = buf[t & (CAPACITY - 1)];
+        return true;
+    }
+    void pop() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+};
+static InputRing inputRing;
+
+static bool SDLCALL captureMouseEvent(void* userdata, SDL_Event* e) {
+    InputEvent in{};
+    in.timeNS = e->common.timestamp;
+    in.type = e->type;
+    if (e->type == SDL_EVENT_MOUSE_MOTION) {
+        in.x = e->motion.x; in.y = e->motion.y;
+        in.xrel = e->motion.xrel; in.yrel = e->motion.yrel;
+    }
+    else if (e->type == SDL_EVENT_MOUSE_BUTTON_DOWN ||
+        e->type == SDL_EVENT_MOUSE_BUTTON_UP) {
+        in.x = e->button.x; in.y = e->button.y;
+        in.button = e->button.button;
+    }
+    else return true;
+    static_cast<InputRing*>(userdata)->push(in);
+    return true;
+}
+
+// --- Simulation thread ---
+// Triple-buffered snapshots: the writer fills its back slot and swaps it
+// into the middle, the reader swaps the middle for its front slot when a
+// newer one is there. Neither side waits, the reader always has a whole
+// snapshot, and slots keep their vectors' capacity between swaps.
+class SnapshotBuffer {
+    static const int FRESH = 4;   // middle was published since the reader's last swap
+    Snapshot slots[3];
+    std::atomic<int> middle{ 1 };
+    int back = 0, last = -1;   // writer side; last: the slot published last
+    int front = 2;             // reader side
+public:
+    // Writer: the slot to fill, its camera set and the prev* fields taken
+    // from the last publish of the same session.
+    Snapshot& begin(Uint32 session, Uint64 timeNS, double camYaw, double camPitch) {
+        Snapshot& s = slots[back];
+        // the last published slot is only ever read until our next publish
+        const Snapshot* l = last >= 0 && slots[last].session == session ? &slots[last] : nullptr;
+        s.session = session;
+        s.timeNS = timeNS;
+        s.camYaw = camYaw; s.camPitch = camPitch;
+        s.prevNS = l ? l->timeNS : timeNS;
+        s.prevYaw = l ? l->camYaw : camYaw;
+        s.prevPitch = l ? l->camPitch : camPitch;
+        return s;
+    }
+    void publish() {
+        Snapshot& s = slots[back];
+        if (!s.moving) s.prevTargets.clear();
+        else if (last >= 0 && slots[last].session == s.session) s.prevTargets = slots[last].targets;
+        else s.prevTargets = s.targets;
+        last = back;
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & 3;
+    }
+    // Reader: the newest snapshot, valid until the next call.
+    const Snapshot& latest() {
+        if (middle.load(std::memory_order_relaxed) & FRESH)
+            front = middle.exchange(front, std::memory_order_acq_rel) & 3;
+        return slots[front];
+    }
+};
+
+// Runs a session's ticks on their own thread so neither a slow present nor
+// a slow tick holds up the other. step(now) runs the ticks due at now,
+// publishes a snapshot and returns when the next tick is due, 0 once the
+// session is over. Between run() and stop() the thread owns everything
+// step() touches; the main thread reads only the snapshots. Without a
+// thread (start() failed) pump() steps the session once per frame.
+class SimThread {
+public:
+    SnapshotBuffer snapshots;
+    // half extents of the live view (deg), for what snapshots must cover
+    std::atomic<float> viewYaw{ 45.0f }, viewPitch{ 30.0f };
+
+    template<class Step>
+    bool start(Step& step) {
+        fn = &step;
+        call = [](void* f, Uint64 now) { return (*static_cast<Step*>(f))(now); };
+        lock = SDL_CreateMutex();
+        wake = SDL_CreateCondition();
+        if (lock && wake) thread = SDL_CreateThread(loopThread, "simulation", this);
+        if (!thread)
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,
+                "Simulation thread unavailable, ticking once per frame: %s", SDL_GetError());
+        return thread != nullptr;
+    }
+    void setView(const Projection& p) {
+        viewYaw.store(p.hFov / 2, std::memory_order_relaxed);
+        viewPitch.store(p.vFov / 2, std::memory_order_relaxed);
+    }
+    // hands over a started session
+    void run() {
+        stopping.store(false, std::memory_order_relaxed);
+        ended.store(false, std::memory_order_relaxed);
+        if (!thread) { running = true; return; }
+        SDL_LockMutex(lock);
+        running = true;
+        SDL_BroadcastCondition(wake);
+        SDL_UnlockMutex(lock);
+    }
+    // the session finished by itself; stop() it before reading its results
+    bool over() const { return ended.load(std::memory_order_acquire); }
+    // takes the session back, ended or not; returns once step() is not running
+    void stop() {
+        if (!thread) { running = false; ended.store(false, std::memory_order_relaxed); return; }
+        stopping.store(true, std::memory_order_release);
+        SDL_LockMutex(lock);
+        while (busy) SDL_WaitCondition(wake, lock);
+        running = false;
+        ended.store(false, std::memory_order_relaxed);
+        SDL_UnlockMutex(lock);
+    }
+    void pump() {
+        if (!thread && running && !ended.load(std::memory_order_relaxed) && !call(fn, SDL_GetTicksNS()))
+            ended.store(true, std::memory_order_relaxed);
+    }
+    void shutdown() {
+        if (thread) {
+            stop();
+            SDL_LockMutex(lock);
+            quit = true;
+            SDL_BroadcastCondition(wake);
+            SDL_UnlockMutex(lock);
+            SDL_WaitThread(thread, nullptr);
+            thread = nullptr;
+        }
+        if (wake) SDL_DestroyCondition(wake);
+        if (lock) SDL_DestroyMutex(lock);
+        wake = nullptr;
+        lock = nullptr;
+    }
+private:
+    SDL_Thread* thread = nullptr;
+    SDL_Mutex* lock = nullptr;
+    SDL_Condition* wake = nullptr;
+    void* fn = nullptr;
+    Uint64 (*call)(void*, Uint64) = nullptr;
+    // guarded by lock
+    bool running = false, busy = false, quit = false;
+    std::atomic<bool> stopping{ false }, ended{ false };
+
+    static int SDLCALL loopThread(void* self) {
+        static_cast<SimThread*>(self)->loop();
+        return 0;
+    }
+    void loop() {
+        Trace::nameThread("simulation");
+        SDL_LockMutex(lock);
+        for (;;) {
+            while (!quit && (!running || stopping.load(std::memory_order_relaxed) ||
+                ended.load(std::memory_order_relaxed)))
+                SDL_WaitCondition(wake, lock);
+            if (quit) break;
+            busy = true;
+            SDL_UnlockMutex(lock);
+            while (!stopping.load(std::memory_order_acquire)) {
+                Uint64 next;
+                {
+                    TRACE_SCOPE("step");
+                    next = call(fn, SDL_GetTicksNS());
+                }
+                if (!next) { ended.store(true, std::memory_order_release); break; }
+                Uint64 now = SDL_GetTicksNS();
+                if (next > now) SDL_DelayNS(next - now);
+            }
+            SDL_LockMutex(lock);
+            busy = false;
+            SDL_BroadcastCondition(wake);
+        }
+        SDL_UnlockMutex(lock);
+    }
+};
+
+// --- MainMenu ---
+class MainMenu {
+public:
+    enum { BTN_GRID, BTN_TRACK, BTN_SWARM, BTN_DRILL, BTN_STATS, BTN_SETT, BTN_CRED, BTN_COUNT };
+    Rect btns[BTN_COUNT];
+    int hover = -1;
+    Uint64 shownCount[MODE_COUNT] = { ~0ull, ~0ull, ~0ull };
+    char statBuf[MODE_COUNT][64] = {};
+    MainMenu() { layout(); }
+    void layout() {
+        int bw = 200, bh = 40;
+        int cx = view.uiW() / 2 - bw / 2;
+        int sy = view.uiH() / 2 - 2 * bh - 20;
+        for (int i = 0;i < BTN_COUNT;++i) btns[i] = { cx,sy + i * 50,bw,bh };
+    }
+    void updateHover(int mx, int my) {
+        hover = -1;
+        for (int i = 0;i < BTN_COUNT;++i)
+            if (pointInRect(mx, my, btns[i])) { hover = i;break; }
+    }
+    void render(SDL_Renderer* ren) {
+        clearScreen(ren);
+        uiScale(ren);
+        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
+        drawText(ren,
+            btns[0].x + btns[0].w / 2 - 60, btns[0].y - 50,
+            "FPS AIM TRAINER");
+        const char* labels[BTN_COUNT] = {
+            "Gridshot Mode","Tracking Mode","Swarm Mode","Custom Drills","Statistics","Settings","Credits"
+        };
+        SDL_Color base{ 80,80,80,255 }, hov{ 100,100,100,255 };
+        for (int i = 0;i < BTN_COUNT;++i) {
+            drawRect(ren, btns[i].x, btns[i].y,
+                btns[i].w, btns[i].h,
+                (hover == i ? hov : base));
+            int tx = btns[i].x + btns[i].w / 2 - (int)strlen(labels[i]) * 4;
+            int ty = btns[i].y + btns[i].h / 2 - 4;
+            SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
+            drawText(ren, tx, ty, labels[i]);
+        }
+        // mode rows are the first buttons; stats only change when a session ends
+        for (int m = 0;m < MODE_COUNT;++m) {
+            const ScoreLog::Stats& st = scoreLog.stats[m];
+            if (st.count != shownCount[m]) {
+                shownCount[m] = st.count;
+                if (st.count)
+                    sprintf(statBuf[m], "Best: %.0f  Avg: %.1f  Median(last %d): %.1f",
+                        st.best, st.mean(), int(st.sorted.size()), st.percentile(0.5));
+                else statBuf[m][0] = 0;
+            }
+            drawText(ren,
+                btns[m].x + btns[m].w + 5,
+                btns[m].y + btns[m].h / 2 - 4,
+                statBuf[m]);
+        }
+    }
+};
+
+// --- GridshotMode ---
+class GridshotMode : public GameMode {
+    struct Target { double yaw, pitch; Uint64 born; bool active; } t[MAX_GRID * MAX_GRID];
+    int cells = 9;
+    int score = 0, streak = 0;
+    Uint64 timeRem = 0, countdown = 0;   // ns
+    bool running = false;
+    SDL_Color tgtCol{ 200,50,50,255 };
+    int hudScore = -1, hudStreak = -1, hudSec = -1;
+    char hud[64] = "";
+
+    // a miss is measured against the nearest live target
+    void logMiss(double cy, double cp, Uint64 intoTickNS) {
+        int best = -1;
+        double bestD = 1e30, by = 0, bp = 0;
+        for (int i = 0;i < cells;++i) {
+            if (!t[i].active) continue;
+            double dy = cy - t[i].yaw;
+            if (dy > 180) dy -= 360; else if (dy < -180) dy += 360;
+            double dp = cp - t[i].pitch;
+            if (dy * dy + dp * dp < bestD) { bestD = dy * dy + dp * dp; best = i; by = dy; bp = dp; }
+        }
+        Uint64 now = playNS(intoTickNS);
+        shots->add(now, cy, cp, by, bp, best < 0 ? 0 : now - t[best].born, false);
+    }
+
+    // cell c of the scenario grid, the outer cells span degrees apart
+    void placeAt(Target& tg, int c) const {
+        int cols = scenario.gridCols, rows = scenario.gridRows;
+        int row = c / cols, col = c % cols;
+        tg.yaw = cols > 1 ? (col - (cols - 1) / 2.0) * (scenario.span / (cols - 1)) : 0.0;
+        tg.pitch = rows > 1 ? ((rows - 1) / 2.0 - row) * (scenario.span / (rows - 1)) : 0.0;
+    }
+public:
+    GridshotMode() : GameMode(MODE_GRIDSHOT) {}
+
+    bool isInCountdown(Uint64 intoTickNS = 0) const { return countdown > intoTickNS; }
+    bool isRunning()    const { return running; }
+    int  getScore()     const { return score; }
+
+    void start()override {
+        score = streak = 0;
+        timeRem = SDL_MS_TO_NS(scenario.durationMs);
+        countdown = SDL_MS_TO_NS(scenario.countdownMs);
+        running = true;
+        cells = scenario.gridCols * scenario.gridRows;
+        int idx[MAX_GRID * MAX_GRID];
+        for (int i = 0;i < cells;++i) idx[i] = i;
+        for (int i = cells - 1;i > 0;--i) std::swap(idx[i], idx[rng.below(i + 1)]);
+        int initial = challengeMode ? scenario.challengeTargets : scenario.targets;
+        for (int i = 0;i < cells;++i) {
+            t[i].active = (i < initial);
+            t[i].born = 0;
+            if (i < initial) placeAt(t[i], idx[i]);
+        }
+    }
+
+    // ns of play at intoTickNS into the coming tick
+    Uint64 playNS(Uint64 intoTickNS) const {
+        return SDL_MS_TO_NS(scenario.durationMs) - timeRem + (intoTickNS > countdown ? intoTickNS - countdown : 0);
+    }
+
+    bool handleClick(double cy, double cp, Uint64 intoTickNS = 0) {
+        TRACE_SCOPE("gridshot.handleClick");
+        double rad = scenario.size;
+        for (int i = 0;i < cells;++i) {
+            if (!t[i].active) continue;
+            double dy = t[i].yaw - cy;
+            if (dy > 180) dy -= 360; else if (dy < -180) dy += 360;
+            double dp = t[i].pitch - cp;
+            if (fabs(dy) <= rad && fabs(dp) <= rad) {
+                Uint64 now = playNS(intoTickNS);
+                if (shots) shots->add(now, cy, cp, -dy, -dp, now - t[i].born, true);
+                score += scenario.hitScore;streak++;
+                t[i].active = false;
+                int freeIdx[MAX_GRID * MAX_GRID], nFree = 0;
+                for (int k = 0;k < cells;++k)
+                    if (k != i && !t[k].active) freeIdx[nFree++] = k;
+                if (nFree) {
+                    int ni = freeIdx[rng.below(nFree)];
+                    t[ni].active = true;
+                    t[ni].born = now;
+                    placeAt(t[ni], ni);
+                }
+                return true;
+            }
+        }
+        if (shots) logMiss(cy, cp, intoTickNS);
+        score -= scenario.missPenalty;
+        streak = 0;
+        return false;
+    }
+
+    void listTargets(double, double, std::vector<TargetInfo>& out) const override {
+        out.clear();
+        for (int i = 0;i < cells;++i)
+            if (t[i].active) out.push_back({ t[i].yaw, t[i].pitch, scenario.size });
+    }
+
+    void update(Uint64 d, double cy, double cp) {
+        TRACE_SCOPE("gridshot.update");
+        if (!running) return;
+        if (countdown > 0) {
+            countdown = (d > countdown ? 0 : countdown - d);
+            return;
+        }
+        if (timeRem > 0) {
+            timeRem = (d > timeRem ? 0 : timeRem - d);
+            if (timeRem == 0) running = false;
+        }
+    }
+
+    void snapshot(Snapshot& s) const override {
+        s.countdown = countdown; s.timeRem = timeRem;
+        s.score = score; s.streak = streak;
+        s.challenge = challengeMode;
+        s.moving = false;
+        s.drawSize = scenario.drawSize * (challengeMode ? scenario.challenge : 1.0);
+        s.reach = scenario.size;
+        s.targets.clear();
+        for (int i = 0;i < cells;++i)
+            if (t[i].active) s.targets.push_back({ t[i].yaw, t[i].pitch, float(scenario.size) });
+    }
+
+    // draws a snapshot at blend a (render thread; the live members belong
+    // to the simulation)
+    void render(SDL_Renderer* ren, const Snapshot& s, float a) {
+        TRACE_SCOPE("gridshot.render");
+        if (s.countdown > 0) {
+            clearScreen(ren);
+            int sec = int((s.countdown + SDL_NS_PER_SECOND / 2) / SDL_NS_PER_SECOND);
             char buf[8];sprintf(buf, "%d", sec);
-            SDL_SetRenderScale(ren, 4.0f, 4.0f);
-            SDL_RenderDebugText(ren,
-                WINDOW_WIDTH / 8 - 4, WINDOW_HEIGHT / 8 - 8, buf);
-            SDL_SetRenderScale(ren, 1.0f, 1.0f);
+            uiScale(ren, 4.0f);
+            drawText(ren,
+                view.uiW() / 8 - 4, view.uiH() / 8 - 8, buf);
+            return;
+        }
+        governor.beginScene(ren);
+        double cy = s.yaw(a), cp = s.pitch(a);
+        int boxRad = int(s.drawSize * view.scale);
+        float dyaw[MAX_GRID * MAX_GRID], dpitch[MAX_GRID * MAX_GRID];
+        float sx[MAX_GRID * MAX_GRID], sy[MAX_GRID * MAX_GRID];
+        int n = 0, vis[MAX_GRID * MAX_GRID];
+        for (const Snapshot::Target& tg : s.targets) {
+            double dy = tg.yaw - cy;
+            if (dy > 180) dy -= 360; else if (dy < -180) dy += 360;
+            dyaw[n] = float(dy);
+            dpitch[n++] = float(tg.pitch - cp);
+        }
+        int nv = liveContext.proj.projectBatch(dyaw, dpitch, n, 5.0f, sx, sy, vis);
+        for (int k = 0;k < nv;++k) {
+            int x = int(sx[vis[k]]), y = int(sy[vis[k]]);
+            drawRect(ren,
+                x - boxRad, y - boxRad,
+                2 * boxRad, 2 * boxRad,
+                tgtCol);
+        }
+        governor.endScene(ren);
+        drawCrosshair(ren);
+
+        uiScale(ren);
+        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
+        int sc = int(s.score), st = int(s.streak);
+        int sec = int(s.timeRem / SDL_NS_PER_SECOND);
+        if (sc != hudScore || st != hudStreak || sec != hudSec) {
+            hudScore = sc; hudStreak = st; hudSec = sec;
+            sprintf(hud, "Score:%d Streak:%d Time:%ds", sc, st, sec);
+        }
+        drawText(ren, 10, 10, hud);
+        if (s.challenge)
+            drawText(ren, 10, 30, "CHALLENGE MODE");
+    }
+
+    void toggleChallengeMode() override {
+        challengeMode = !challengeMode;
+    }
+};
+
+// --- MotionEngine ---
+// Moves a set of tracking targets with one MotionPattern. Each field is its
+// own array (structure-of-arrays) and everything advances in fixed 1 ms
+// steps whatever the tick rate, so positions depend only on session time
+// and the seed. A step is a few straight passes over the arrays (integrate,
+// bounce off the bounds, count timers) that the compiler vectorizes; the
+// pattern logic that picks new velocities only runs for targets whose
+// timer ran out.
+class MotionEngine {
+public:
+    static const Uint64 STEP_NS = 1000000;
+    static constexpr float DT = 0.001f;   // seconds per step
+
+    // limYaw/limPitch: half extent of the area (deg); speed in deg/s
+    void reset(int motionPattern, int count, float limYaw, float limPitch, float speedDeg, Uint64 seed) {
+        pattern = CLAMP(motionPattern, 0, MOTION_COUNT - 1);
+        n = std::max(count, 0);
+        limY = limYaw; limP = limPitch; speed = speedDeg;
+        vmax = pattern == MOTION_ACCEL ? 1.5f * speed : 4.0f * speed;
+        rng.seed(seed);
+        for (std::vector<float>* a : { &x, &y, &vx, &vy, &ax, &ay, &timer })
+            a->assign(n, 0.0f);
+        for (int k = 0; k < 4; ++k) { kx[k].assign(n, 0.0f); ky[k].assign(n, 0.0f); }
+        u.assign(n, 0.0f);
+        du.assign(n, 0.0f);
+        for (int i = 0; i < n; ++i) {
+            x[i] = float(rng.uniform(-0.8, 0.8)) * limY;
+            y[i] = float(rng.uniform(-0.8, 0.8)) * limP;
+            if (pattern == MOTION_SPLINE) {
+                // knots 0 and 1 at the start, so the path leaves from there
+                kx[0][i] = kx[1][i] = x[i];
+                ky[0][i] = ky[1][i] = y[i];
+                for (int k = 2; k < 4; ++k) { kx[k][i] = randomX(); ky[k][i] = randomY(); }
+                du[i] = segmentRate(i);
+            }
+            else if (pattern == MOTION_BOUNCE) {
+                vx[i] = rng.below(2) ? speed : -speed;
+                vy[i] = rng.below(2) ? 0.75f * speed : -0.75f * speed;
+                timer[i] = 1e30f;
+            }
+            else {
+                vx[i] = rng.below(2) ? speed : -speed;
+                retarget(i);
+            }
+        }
+    }
+
+    void step() {
+        if (pattern == MOTION_SPLINE) { stepSpline(); return; }
+        int due = integrate(n, x.data(), y.data(), vx.data(), vy.data(), ax.data(), ay.data(),
+            timer.data(), limY, limP, vmax);
+        if (due)
+            for (int i = 0; i < n; ++i)
+                if (timer[i] <= 0) retarget(i);
+    }
+
+    // targets whose square of half-size rad contains the aim point
+    int hits(float aimYaw, float aimPitch, float rad) const {
+        const float* px = x.data(); const float* py = y.data();
+        int h = 0;
+        for (int i = 0; i < n; ++i)
+            h += (fabsf(px[i] - aimYaw) <= rad) & (fabsf(py[i] - aimPitch) <= rad);
+        return h;
+    }
+
+    int size() const { return n; }
+    const float* yaw() const { return x.data(); }
+    const float* pitch() const { return y.data(); }
+
+private:
+    int pattern = MOTION_BOUNCE, n = 0;
+    float limY = 0, limP = 0, speed = 0, vmax = 0;
+    Rng rng;
+    std::vector<float> x, y, vx, vy, ax, ay, timer;   // timer: s until retarget()
+    // MOTION_SPLINE: Catmull-Rom knots 0..3 per axis, progress through the
+    // knot 1 -> 2 segment and its rate per second
+    std::vector<float> kx[4], ky[4], u, du;
+
+    // One kinematic step for all targets; returns how many timers ran out.
+    // Restrict-qualified arrays and plain selects between computed values
+    // let the loop if-convert and vectorize.
+    static int integrate(int n, float* __restrict px, float* __restrict py,
+        float* __restrict pvx, float* __restrict pvy,
+        const float* __restrict pax, const float* __restrict pay,
+        float* __restrict pt, float lx, float ly, float vm) {
+        int due = 0;
+        for (int i = 0; i < n; ++i) {
+            float nvx = pvx[i] + pax[i] * DT, nvy = pvy[i] + pay[i] * DT;
+            nvx = CLAMP(nvx, -vm, vm);
+            nvy = CLAMP(nvy, -vm, vm);
+            float nx = px[i] + nvx * DT, ny = py[i] + nvy * DT;
+            // reflect off the bounds: o is how far past one (signed), and a
+            // target past a bound was moving toward it, so its velocity flips
+            float hx = nx - lx, lox = nx + lx, hy = ny - ly, loy = ny + ly;
+            float ox = (hx > 0 ? hx : 0.0f) + (lox < 0 ? lox : 0.0f);
+            float oy = (hy > 0 ? hy : 0.0f) + (loy < 0 ? loy : 0.0f);
+            px[i] = nx - 2 * ox;
+            py[i] = ny - 2 * oy;
+            pvx[i] = ox != 0 ? -nvx : nvx;
+            pvy[i] = oy != 0 ? -nvy : nvy;
+            pt[i] -= DT;
+            due += pt[i] <= 0;
+        }
+        return due;
+    }
+
+    float randomX() { return float(rng.uniform(-1.0, 1.0)) * limY; }
+    float randomY() { return float(rng.uniform(-1.0, 1.0)) * limP; }
+    // roughly constant speed along the chord between knots 1 and 2
+    float segmentRate(int i) const {
+        float dx = kx[2][i] - kx[1][i], dy = ky[2][i] - ky[1][i];
+        return speed / std::max(sqrtf(dx * dx + dy * dy), 1.0f);
+    }
+
+    // new velocity/acceleration and timer for one target of the kinematic patterns
+    void retarget(int i) {
+        float dir = vx[i] < 0 ? -1.0f : 1.0f;
+        switch (pattern) {
+        case MOTION_STRAFE:   // mostly sideways, reversing at random
+            vx[i] = -dir * speed * float(rng.uniform(0.7, 1.3));
+            vy[i] = speed * float(rng.uniform(-0.15, 0.15));
+            timer[i] = float(rng.uniform(0.25, 1.2));
+            break;
+        case MOTION_ACCEL:    // a new random acceleration every few hundred ms
+            ax[i] = speed * float(rng.uniform(-4.0, 4.0));
+            ay[i] = speed * float(rng.uniform(-3.0, 3.0));
+            timer[i] = float(rng.uniform(0.3, 0.8));
+            break;
+        case MOTION_ADAD:     // short, fast left-right jitter
+            vx[i] = -dir * speed * float(rng.uniform(1.2, 1.8));
+            vy[i] = 0;
+            timer[i] = float(rng.uniform(0.12, 0.35));
+            break;
+        default:
+            timer[i] = 1e30f;
+        }
+    }
+
+    // p = the Catmull-Rom segment between k1 and k2 at t
+    static void catmullRom(int n, const float* __restrict t, const float* __restrict k0,
+        const float* __restrict k1, const float* __restrict k2, const float* __restrict k3,
+        float* __restrict p) {
+        for (int i = 0; i < n; ++i) {
+            float t1 = t[i], t2 = t1 * t1, t3 = t2 * t1;
+            float w0 = -0.5f * t3 + t2 - 0.5f * t1, w1 = 1.5f * t3 - 2.5f * t2 + 1.0f;
+            float w2 = -1.5f * t3 + 2.0f * t2 + 0.5f * t1, w3 = 0.5f * t3 - 0.5f * t2;
+            p[i] = w0 * k0[i] + w1 * k1[i] + w2 * k2[i] + w3 * k3[i];
+        }
+    }
+
+    void stepSpline() {
+        int due = 0;
+        for (int i = 0; i < n; ++i) {
+            u[i] += du[i] * DT;
+            due += u[i] >= 1.0f;
+        }
+        for (int i = 0; due && i < n; ++i) {
+            if (u[i] < 1.0f) continue;
+            // next segment: shift the knots, add one
+            for (int k = 0; k < 3; ++k) { kx[k][i] = kx[k + 1][i]; ky[k][i] = ky[k + 1][i]; }
+            kx[3][i] = randomX();
+            ky[3][i] = randomY();
+            u[i] -= 1.0f;
+            du[i] = segmentRate(i);
+            --due;
+        }
+        catmullRom(n, u.data(), kx[0].data(), kx[1].data(), kx[2].data(), kx[3].data(), x.data());
+        catmullRom(n, u.data(), ky[0].data(), ky[1].data(), ky[2].data(), ky[3].data(), y.data());
+    }
+};
+
+// --- TrackingMode ---
+// Targets move with the configured MotionPattern. Scoring walks the motion
+// engine's 1 ms steps: within a step targets move linearly between the
+// engine's positions, and each stretch between aim changes counts for the
+// exact part of it the aim is on a target. Steps are placed in session
+// time, not ticks, so the score is the same at any tick or frame rate.
+class TrackingMode : public GameMode {
+    struct Tally { double score, streak, best; };
+    struct AimAt { Uint64 intoNS; float yaw, pitch; };   // intoNS: into the step
+    struct Span { double lo, hi; };
+
+    MotionEngine motion;
+    double factor = 1;
+    Tally done{};   // scored up to scoredNS
+    double aimYaw = 0, aimPitch = 0;
+    Uint64 playNS = 0, scoredNS = 0;   // scoredNS: motion engine time, whole steps
+    // aim over the step from scoredNS: the aim it began with, then each change
+    std::vector<AimAt> stepAim;
+    std::vector<float> fromYaw, fromPitch;   // engine positions at scoredNS
+    Uint64 timeRem = 0, countdown = 0;   // ns
+    bool running = false;
+    SDL_Color tgtCol{ 200,50,200,255 };
+    int hudScore = -1, hudBest = -1, hudSec = -1;   // tenths of a second
+    char hud[64] = "";
+
+    // narrows [lo, hi] to the u in it where |p + d*u - a| <= r
+    static void clip(double p, double d, double a, double r, double& lo, double& hi) {
+        if (d == 0) {
+            if (fabs(p - a) > r) hi = lo;
+            return;
+        }
+        double u0 = (a - r - p) / d, u1 = (a + r - p) / d;
+        if (d < 0) std::swap(u0, u1);
+        lo = std::max(lo, u0);
+        hi = std::min(hi, u1);
+    }
+
+    // Scores step fraction [u0, u1) held at aim (ay, ap), with every target
+    // moving linearly from fromYaw/fromPitch to the engine's positions.
+    void scoreSpan(double u0, double u1, float ay, float ap) {
+        double rad = scenario.size;
+        double perU = MotionEngine::STEP_NS / 1e9 * factor;   // score for a whole step
+        Span on[MAX_TRACK_TARGETS];
+        int n = 0;
+        for (int i = 0; i < motion.size() && n < MAX_TRACK_TARGETS; ++i) {
+            double lo = u0, hi = u1;
+            clip(fromYaw[i], motion.yaw()[i] - fromYaw[i], ay, rad, lo, hi);
+            clip(fromPitch[i], motion.pitch()[i] - fromPitch[i], ap, rad, lo, hi);
+            if (lo >= hi) continue;
+            int k = n++;
+            for (; k > 0 && on[k - 1].lo > lo; --k) on[k] = on[k - 1];
+            on[k] = { lo, hi };
+        }
+        double at = u0;   // covered up to here
+        for (int k = 0; k < n; ++k) {
+            if (on[k].hi <= at) continue;
+            if (on[k].lo > at) { done.streak = 0; at = on[k].lo; }
+            double dt = (on[k].hi - at) * perU;
+            done.score += dt;
+            done.streak += dt;
+            done.best = std::max(done.best, done.streak);
+            at = on[k].hi;
+        }
+        if (at < u1) done.streak = 0;
+    }
+
+    // Scores and advances the engine over every step that ends by untilNS.
+    // A step is scored only once it is complete, split at the aim changes
+    // inside it, so where ticks fall does not change the result.
+    void commit(Uint64 untilNS) {
+        const Uint64 STEP = MotionEngine::STEP_NS;
+        for (; scoredNS + STEP <= untilNS; scoredNS += STEP) {
+            fromYaw.assign(motion.yaw(), motion.yaw() + motion.size());
+            fromPitch.assign(motion.pitch(), motion.pitch() + motion.size());
+            motion.step();
+            for (size_t k = 0; k < stepAim.size(); ++k) {
+                Uint64 end = k + 1 < stepAim.size() ? stepAim[k + 1].intoNS : STEP;
+                scoreSpan(double(stepAim[k].intoNS) / STEP, double(end) / STEP,
+                    stepAim[k].yaw, stepAim[k].pitch);
+            }
+            AimAt last = stepAim.back();
+            stepAim.assign(1, { 0, last.yaw, last.pitch });
+        }
+    }
+    // the aim from atNS of play on
+    void setAim(Uint64 atNS, double cy, double cp) {
+        aimYaw = cy;
+        aimPitch = cp;
+        AimAt a{ atNS > scoredNS ? atNS - scoredNS : 0, float(remainder(cy, 360.0)), float(cp) };
+        if (stepAim.back().intoNS >= a.intoNS) stepAim.back() = { stepAim.back().intoNS, a.yaw, a.pitch };
+        else stepAim.push_back(a);
+    }
+public:
+    TrackingMode() : GameMode(MODE_TRACKING) {}
+    // intoTickNS: how far into the coming tick an input event happened
+    bool isInCountdown(Uint64 intoTickNS = 0) const { return countdown > intoTickNS; }
+    bool isRunning()    const { return running; }
+    double getScore()   const { return done.score; }   // final once !isRunning()
+    void listTargets(double, double, std::vector<TargetInfo>& out) const override {
+        out.clear();
+        for (int i = 0;i < motion.size();++i)
+            out.push_back({ motion.yaw()[i], motion.pitch()[i], scenario.size });
+    }
+    void start() override {
+        done = Tally{};
+        timeRem = SDL_MS_TO_NS(scenario.durationMs);
+        countdown = SDL_MS_TO_NS(scenario.countdownMs);
+        running = true;
+        playNS = scoredNS = 0;
+        stepAim.assign(1, { 0, float(remainder(aimYaw, 360.0)), float(aimPitch) });
+        factor = challengeMode ? scenario.challenge : 1.0;
+        double limY = ctx->proj.hFov / 2 - 5, limP = ctx->proj.vFov / 2 - 5;
+        int count = challengeMode ? scenario.challengeTargets : scenario.targets;
+        motion.reset(scenario.pattern, CLAMP(count, 1, MAX_TRACK_TARGETS),
+            float(limY), float(limP), float(scenario.speed * factor), rng.next());
+    }
+    // The camera moved to cy/cp intoTickNS into the coming tick; time up to
+    // then is scored against the previous aim, to the nanosecond.
+    void aim(Uint64 intoTickNS, double cy, double cp) {
+        TRACE_SCOPE("tracking.aim");
+        if (!running || intoTickNS < countdown) return;
+        Uint64 at = std::min<Uint64>(playNS + intoTickNS - countdown, SDL_MS_TO_NS(scenario.durationMs));
+        commit(at);
+        setAim(at, cy, cp);
+    }
+    void update(Uint64 d, double cy, double cp) {
+        TRACE_SCOPE("tracking.update");
+        if (!running) return;
+        if (countdown > 0) {
+            setAim(0, cy, cp);   // the camera is frozen until play starts
+            if (d <= countdown) { countdown -= d; return; }
+            d -= countdown;
+            countdown = 0;
+        }
+        if (cy != aimYaw || cp != aimPitch) aim(0, cy, cp);   // caller skipped aim()
+        Uint64 duration = SDL_MS_TO_NS(scenario.durationMs);
+        playNS = std::min<Uint64>(playNS + d, duration);
+        timeRem = duration - playNS;
+        commit(playNS);
+        if (timeRem == 0) running = false;
+    }
+    void snapshot(Snapshot& s) const override {
+        s.countdown = countdown; s.timeRem = timeRem;
+        s.score = done.score; s.streak = done.best;
+        s.challenge = challengeMode;
+        s.moving = true;
+        s.drawSize = scenario.drawSize;
+        s.reach = scenario.size;
+        int n = std::min(motion.size(), MAX_TRACK_TARGETS);
+        s.targets.resize(n);
+        for (int i = 0;i < n;++i)
+            s.targets[i] = { motion.yaw()[i], motion.pitch()[i], float(scenario.size) };
+    }
+    void render(SDL_Renderer* ren, const Snapshot& s, float a) {
+        TRACE_SCOPE("tracking.render");
+        if (s.countdown > 0) {
+            clearScreen(ren);
+            int sec = int((s.countdown + SDL_NS_PER_SECOND / 2) / SDL_NS_PER_SECOND);
+            char buf[8];sprintf(buf, "%d", sec);
+            uiScale(ren, 4.0f);
+            drawText(ren,
+                view.uiW() / 8 - 4, view.uiH() / 8 - 8, buf);
+            return;
+        }
+        governor.beginScene(ren);
+        double cy = s.yaw(a), cp = s.pitch(a);
+        float dyaw[MAX_TRACK_TARGETS], dpitch[MAX_TRACK_TARGETS];
+        float sx[MAX_TRACK_TARGETS], sy[MAX_TRACK_TARGETS];
+        int vis[MAX_TRACK_TARGETS];
+        int n = int(std::min<size_t>(s.targets.size(), MAX_TRACK_TARGETS));
+        for (int i = 0;i < n;++i) {
+            Snapshot::Target tg = s.target(i, a);
+            double dy = tg.yaw - cy;
+            dy = remainder(dy, 360.0);
+            dyaw[i] = float(dy);
+            dpitch[i] = float(tg.pitch - cp);
+        }
+        int nv = liveContext.proj.projectBatch(dyaw, dpitch, n, 0.0f, sx, sy, vis);
+        int rad = int(s.drawSize * view.scale);
+        for (int k = 0;k < nv;++k)
+            drawRect(ren, int(sx[vis[k]]) - rad, int(sy[vis[k]]) - rad, 2 * rad, 2 * rad, tgtCol);
+        governor.endScene(ren);
+        drawCrosshair(ren);
+        uiScale(ren);
+        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
+        int sc = int(s.score * 10), bs = int(s.streak * 10);
+        int sec = int(s.timeRem / SDL_NS_PER_SECOND);
+        if (sc != hudScore || bs != hudBest || sec != hudSec) {
+            hudScore = sc; hudBest = bs; hudSec = sec;
+            sprintf(hud, "OnTarget:%.1fs Best:%.1fs Time:%ds", s.score, s.streak, sec);
+        }
+        drawText(ren, 10, 10, hud);
+        if (s.challenge)
+            drawText(ren, 10, 30, "CHALLENGE MODE");
+    }
+    void toggleChallengeMode() override {
+        challengeMode = !challengeMode;
+    }
+};
+
+// --- Angular spatial index ---
+// Buckets target ids by yaw/pitch cell. Queries visit only the cells that
+// overlap a yaw/pitch window, so hit tests and view culling cost scales
+// with the number of nearby targets rather than the total.
+class AngularGrid {
+public:
+    static const int CELL_DEG = 4;
+    static const int COLS = 360 / CELL_DEG, ROWS = 180 / CELL_DEG;
+
+    void reset(int ids) {
+        for (auto& c : cells) c.clear();
+        cellOf.assign(ids, -1);
+        slotOf.assign(ids, -1);
+    }
+    void insert(int id, double yaw, double pitch) {
+        int c = rowOf(pitch) * COLS + colOf(int(floor(yaw / CELL_DEG)));
+        cellOf[id] = c;
+        slotOf[id] = int(cells[c].size());
+        cells[c].push_back(id);
+    }
+    void remove(int id) {
+        std::vector<int>& cell = cells[cellOf[id]];
+        int last = cell.back();
+        cell[slotOf[id]] = last;
+        slotOf[last] = slotOf[id];
+        cell.pop_back();
+        cellOf[id] = slotOf[id] = -1;
+    }
+    // calls visit(id) for every target bucketed within the window
+    template<class F>
+    void query(double yaw, double pitch, double halfYaw, double halfPitch, F&& visit) const {
+        int c0 = int(floor((yaw - halfYaw) / CELL_DEG));
+        int c1 = int(floor((yaw + halfYaw) / CELL_DEG));
+        if (c1 - c0 >= COLS) { c0 = 0; c1 = COLS - 1; }
+        int r0 = rowOf(pitch - halfPitch), r1 = rowOf(pitch + halfPitch);
+        for (int c = c0;c <= c1;++c) {
+            int col = colOf(c);
+            for (int r = r0;r <= r1;++r)
+                for (int id : cells[r * COLS + col]) visit(id);
+        }
+    }
+private:
+    std::vector<int> cells[COLS * ROWS];
+    std::vector<int> cellOf, slotOf;   // per id: bucket and index within it
+
+    static int colOf(int c) { return ((c % COLS) + COLS) % COLS; }
+    static int rowOf(double pitch) {
+        int r = int(floor((pitch + 90.0) / CELL_DEG));
+        return CLAMP(r, 0, ROWS - 1);
+    }
+};
+
+// --- SwarmMode ---
+// Thousands of live targets of varying size around the player. A hit
+// respawns the target elsewhere; everything goes through AngularGrid.
+class SwarmMode : public GameMode {
+    struct Target { double yaw, pitch, rad; Uint64 born; };   // rad: angular half-size (deg)
+    std::vector<Target> t;
+    AngularGrid index;
+    int score = 0, streak = 0;
+    Uint64 timeRem = 0, countdown = 0;   // ns
+    bool running = false;
+    SDL_Color tgtCol{ 230,140,40,255 };
+    int hudScore = -1, hudStreak = -1, hudSec = -1;
+    char hud[64] = "";
+    // render scratch (SoA for Projection::projectBatch)
+    std::vector<int> vis;
+    std::vector<float> dyaw, dpitch, sx, sy;
+
+    double radScale() const { return challengeMode ? scenario.challenge : 1.0; }
+    // a miss is measured against the nearest target: widen the window until
+    // the closest one found is inside it (anything outside is further away)
+    void logMiss(double cy, double cp, Uint64 intoTickNS) {
+        int best = -1;
+        double bestD = 1e30, by = 0, bp = 0;
+        for (double w = std::max(scenario.maxSize * radScale(), double(AngularGrid::CELL_DEG));; w *= 2) {
+            index.query(cy, cp, w, w, [&](int i) {
+                double dy = cy - t[i].yaw;
+                if (dy > 180) dy -= 360; else if (dy < -180) dy += 360;
+                double dp = cp - t[i].pitch;
+                if (dy * dy + dp * dp < bestD) { bestD = dy * dy + dp * dp; best = i; by = dy; bp = dp; }
+                });
+            if ((best >= 0 && bestD <= w * w) || w >= 180) break;
+        }
+        Uint64 now = playNS(intoTickNS);
+        shots->add(now, cy, cp, by, bp, best < 0 ? 0 : now - t[best].born, false);
+    }
+    void place(int i, Uint64 born = 0) {
+        double fieldYaw = scenario.fieldYaw, fieldPitch = scenario.fieldPitch;
+        t[i].born = born;
+        t[i].yaw = rng.uniform(-fieldYaw, fieldYaw);
+        if (t[i].yaw < 0) t[i].yaw += 360;
+        t[i].pitch = rng.uniform(-fieldPitch, fieldPitch);
+        t[i].rad = rng.uniform(scenario.size, scenario.maxSize);
+        index.insert(i, t[i].yaw, t[i].pitch);
+    }
+public:
+    SwarmMode() : GameMode(MODE_SWARM) {}
+
+    bool isInCountdown(Uint64 intoTickNS = 0) const { return countdown > intoTickNS; }
+    bool isRunning()    const { return running; }
+    int  getScore()     const { return score; }
+
+    void start() override {
+        score = streak = 0;
+        timeRem = SDL_MS_TO_NS(scenario.durationMs);
+        countdown = SDL_MS_TO_NS(scenario.countdownMs);
+        running = true;
+        int targetCount = challengeMode ? scenario.challengeTargets : scenario.targets;
+        t.resize(targetCount);
+        index.reset(targetCount);
+        for (int i = 0;i < targetCount;++i) place(i);
+    }
+
+    // ns of play at intoTickNS into the coming tick
+    Uint64 playNS(Uint64 intoTickNS) const {
+        return SDL_MS_TO_NS(scenario.durationMs) - timeRem + (intoTickNS > countdown ? intoTickNS - countdown : 0);
+    }
+
+    bool handleClick(double cy, double cp, Uint64 intoTickNS = 0) {
+        TRACE_SCOPE("swarm.handleClick");
+        double reach = scenario.maxSize * radScale();
+        int hit = -1;
+        double bestD = 1e9;
+        index.query(cy, cp, reach, reach, [&](int i) {
+            double dy = t[i].yaw - cy;
+            if (dy > 180) dy -= 360; else if (dy < -180) dy += 360;
+            double dp = t[i].pitch - cp;
+            double r = t[i].rad * radScale();
+            if (fabs(dy) <= r && fabs(dp) <= r && fabs(dy) + fabs(dp) < bestD) {
+                bestD = fabs(dy) + fabs(dp);
+                hit = i;
+            }
+            });
+        if (hit < 0) {
+            if (shots) logMiss(cy, cp, intoTickNS);
+            score -= scenario.missPenalty; streak = 0; return false;
+        }
+        Uint64 now = playNS(intoTickNS);
+        if (shots) {
+            double dy = cy - t[hit].yaw;
+            if (dy > 180) dy -= 360; else if (dy < -180) dy += 360;
+            shots->add(now, cy, cp, dy, cp - t[hit].pitch, now - t[hit].born, true);
+        }
+        score += scenario.hitScore; streak++;
+        index.remove(hit);
+        place(hit, now);
+        return true;
+    }
+
+    void listTargets(double cy, double cp, std::vector<TargetInfo>& out) const override {
+        out.clear();
+        double scale = radScale();
+        index.query(cy, cp, ctx->proj.hFov / 2, ctx->proj.vFov / 2, [&](int i) {
+            out.push_back({ t[i].yaw, t[i].pitch, t[i].rad * scale });
+            });
+    }
+
+    void update(Uint64 d, double cy, double cp) {
+        TRACE_SCOPE("swarm.update");
+        if (!running) return;
+        if (countdown > 0) {
+            countdown = (d > countdown ? 0 : countdown - d);
+            return;
+        }
+        if (timeRem > 0) {
+            timeRem = (d > timeRem ? 0 : timeRem - d);
+            if (timeRem == 0) running = false;
+        }
+    }
+
+    // Only the targets a frame blending between the previous publish's
+    // camera and this one can show: the window around both, through the
+    // index. Targets never move, so the render thread takes them as is.
+    void snapshot(Snapshot& s) const override {
+        s.countdown = countdown; s.timeRem = timeRem;
+        s.score = score; s.streak = streak;
+        s.challenge = challengeMode;
+        s.moving = false;
+        s.drawSize = 0;
+        double scale = radScale();
+        s.reach = scenario.maxSize * scale;
+        double dy = s.camYaw - s.prevYaw, dp = s.camPitch - s.prevPitch;
+        if (dy > 180) dy -= 360; else if (dy < -180) dy += 360;
+        s.targets.clear();
+        index.query(s.prevYaw + dy / 2, s.prevPitch + dp / 2,
+            s.viewYaw + s.reach + fabs(dy) / 2, s.viewPitch + s.reach + fabs(dp) / 2, [&](int i) {
+                s.targets.push_back({ t[i].yaw, t[i].pitch, float(t[i].rad * scale) });
+            });
+    }
+
+    // Projects a snapshot's targets from cy/cp; returns how many are on
+    // screen (s.targets[vis[k]], position sx/sy[vis[k]]).
+    int gatherVisible(const Snapshot& s, double cy, double cp) {
+        size_t n = s.targets.size();
+        dyaw.resize(n); dpitch.resize(n);
+        sx.resize(n); sy.resize(n); vis.resize(n);
+        for (size_t k = 0;k < n;++k) {
+            double dy = s.targets[k].yaw - cy;
+            if (dy > 180) dy -= 360; else if (dy < -180) dy += 360;
+            dyaw[k] = float(dy);
+            dpitch[k] = float(s.targets[k].pitch - cp);
+        }
+        return liveContext.proj.projectBatch(dyaw.data(), dpitch.data(), int(n), float(s.reach),
+            sx.data(), sy.data(), vis.data());
+    }
+
+    void render(SDL_Renderer* ren, const Snapshot& s, float a) {
+        TRACE_SCOPE("swarm.render");
+        if (s.countdown > 0) {
+            clearScreen(ren);
+            int sec = int((s.countdown + SDL_NS_PER_SECOND / 2) / SDL_NS_PER_SECOND);
+            char buf[8];sprintf(buf, "%d", sec);
+            uiScale(ren, 4.0f);
+            drawText(ren,
+                view.uiW() / 8 - 4, view.uiH() / 8 - 8, buf);
+            return;
+        }
+        governor.beginScene(ren);
+        int nv = gatherVisible(s, s.yaw(a), s.pitch(a));
+        double pxPerDeg = liveContext.proj.kx * M_PI / 180.0;
+        for (int k = 0;k < nv;++k) {
+            int j = vis[k];
+            int r = std::max(1, int(s.targets[j].rad * pxPerDeg));
+            drawRect(ren, int(sx[j]) - r, int(sy[j]) - r, 2 * r, 2 * r, tgtCol);
+        }
+        governor.endScene(ren);
+        drawCrosshair(ren);
+        uiScale(ren);
+        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
+        int sc = int(s.score), st = int(s.streak);
+        int sec = int(s.timeRem / SDL_NS_PER_SECOND);
+        if (sc != hudScore || st != hudStreak || sec != hudSec) {
+            hudScore = sc; hudStreak = st; hudSec = sec;
+            sprintf(hud, "Score:%d Streak:%d Time:%ds", sc, st, sec);
+        }
+        drawText(ren, 10, 10, hud);
+        if (s.challenge)
+            drawText(ren, 10, 30, "CHALLENGE MODE");
+    }
+
+    void toggleChallengeMode() override {
+        challengeMode = !challengeMode;
+    }
+};
+
+// --- SettingsMenu ---
+class SettingsMenu {
+public:
+    float sensVal, fovVal;
+    int gapVal, lenVal, rVal, gVal, bVal, capVal, pacingVal, patternVal, targetsVal;
+    bool challengeVal;
+    Rect capBar, sensBar, fovBar, gapBar, lenBar, rBar, gBar, bBar;
+    Rect capKnob, sensKnob, fovKnob, gapKnob, lenKnob, rKnob, gKnob, bKnob;
+    Rect applyBtn, resetBtn, challengeBtn, pacingBtn, patternBtn, targetsBtn;
+    int dragging, hoverBtn;
+    bool hoverChallenge, hoverPacing, hoverPattern, hoverTargets;
+    // value labels, reformatted only when a value changes
+    char capTxt[16], sensTxt[16], fovTxt[16], gapTxt[16], lenTxt[16];
+    char rTxt[16], gTxt[16], bTxt[16], challengeTxt[32], pacingTxt[32];
+    char patternTxt[32], targetsTxt[32];
+
+    SettingsMenu() {
+        sensVal = config.sensitivity;
+        fovVal = config.fov;
+        gapVal = config.cross_gap;
+        lenVal = config.cross_len;
+        rVal = config.cross_r;
+        gVal = config.cross_g;
+        bVal = config.cross_b;
+        challengeVal = config.challengeMode;
+        capVal = config.fpsCap;
+        pacingVal = config.pacingMode;
+        patternVal = config.trackPattern;
+        targetsVal = config.trackTargets;
+        dragging = 0;hoverBtn = -1;hoverChallenge = hoverPacing = hoverPattern = hoverTargets = false;
+        layout();
+    }
+
+    void layout() {
+        int mx = view.uiW() / 2, my = view.uiH() / 2;
+        capBar = { mx - 150,my - 120,300,6 };
+        sensBar = { mx - 150,my - 80,300,6 };
+        fovBar = { mx - 150,my - 40,300,6 };
+        gapBar = { mx - 150,my,   300,6 };
+        lenBar = { mx - 150,my + 40,300,6 };
+        rBar = { mx - 150,my + 80,300,6 };
+        gBar = { mx - 150,my + 120,300,6 };
+        bBar = { mx - 150,my + 160,300,6 };
+
+        capKnob.w = capKnob.h =
+            sensKnob.w = sensKnob.h =
+            fovKnob.w = fovKnob.h =
+            gapKnob.w = gapKnob.h =
+            lenKnob.w = lenKnob.h =
+            rKnob.w = rKnob.h =
+            gKnob.w = gKnob.h =
+            bKnob.w = bKnob.h = 12;
+
+        applyBtn = { mx - 100,my + 200,80,30 };
+        resetBtn = { mx + 20, my + 200,80,30 };
+        challengeBtn = { mx - 100,my + 250,200,30 };
+        pacingBtn = { mx - 100,my + 290,200,30 };
+        patternBtn = { mx + 120,my + 250,200,30 };
+        targetsBtn = { mx + 120,my + 290,200,30 };
+        updateKnobs();
+    }
+
+    void updateKnobs() {
+        auto place = [&](const Rect& bar, Rect& knob, float val, float mn, float mx) {
+            float n = (val - mn) / (mx - mn);
+            n = CLAMP(n, 0.f, 1.f);
+            knob.x = bar.x + int(n * bar.w) - knob.w / 2;
+            knob.y = bar.y - knob.h / 2 + bar.h / 2;
+            };
+        place(capBar, capKnob, float(capVal), float(MIN_FPS_CAP), float(MAX_FPS_CAP));
+        place(sensBar, sensKnob, sensVal, 0.001f, 3.0f);
+        place(fovBar, fovKnob, fovVal, 60.0f, 130.0f);
+        place(gapBar, gapKnob, float(gapVal), 0.0f, 50.0f);
+        place(lenBar, lenKnob, float(lenVal), 0.0f, 100.0f);
+        place(rBar, rKnob, float(rVal), 0.0f, 255.0f);
+        place(gBar, gKnob, float(gVal), 0.0f, 255.0f);
+        place(bBar, bKnob, float(bVal), 0.0f, 255.0f);
+        sprintf(capTxt, "%d", capVal);
+        sprintf(sensTxt, "%.3f", sensVal);
+        sprintf(fovTxt, "%.0f", fovVal);
+        sprintf(gapTxt, "%d", gapVal);
+        sprintf(lenTxt, "%d", lenVal);
+        sprintf(rTxt, "%d", rVal);
+        sprintf(gTxt, "%d", gVal);
+        sprintf(bTxt, "%d", bVal);
+        sprintf(challengeTxt, "Challenge Mode: %s", challengeVal ? "ON" : "OFF");
+        sprintf(pacingTxt, "Frame Pacing: %s", PACING_NAMES[pacingVal]);
+        sprintf(patternTxt, "Tracking: %s", MOTION_NAMES[patternVal]);
+        sprintf(targetsTxt, "Tracking Targets: %d", targetsVal);
+    }
+
+    void handleMouseDown(int mx, int my) {
+        auto start = [&](const Rect& bar, const Rect& knob, int code) {
+            if (pointInRect(mx, my, bar) || pointInRect(mx, my, knob)) {
+                dragging = code;return true;
+            }
+            return false;
+            };
+        if (start(sensBar, sensKnob, 1))return;
+        if (start(fovBar, fovKnob, 2))return;
+        if (start(gapBar, gapKnob, 3))return;
+        if (start(lenBar, lenKnob, 4))return;
+        if (start(rBar, rKnob, 5))return;
+        if (start(gBar, gKnob, 6))return;
+        if (start(bBar, bKnob, 7))return;
+        if (start(capBar, capKnob, 8))return;
+
+        if (pointInRect(mx, my, applyBtn))hoverBtn = 1;
+        else if (pointInRect(mx, my, resetBtn))hoverBtn = 2;
+        else if (pointInRect(mx, my, challengeBtn)) {
+            challengeVal = !challengeVal;
+            updateKnobs();
+            return;
+        }
+        else if (pointInRect(mx, my, pacingBtn)) {
+            pacingVal = (pacingVal + 1) % PACE_COUNT;
+            updateKnobs();
+            return;
+        }
+        else if (pointInRect(mx, my, patternBtn)) {
+            patternVal = (patternVal + 1) % MOTION_COUNT;
+            updateKnobs();
+            return;
+        }
+        else if (pointInRect(mx, my, targetsBtn)) {
+            targetsVal = targetsVal % MAX_TRACK_TARGETS + 1;
+            updateKnobs();
+            return;
+        }
+    }
+    void handleMouseUp() { dragging = 0; }
+    void handleMouseMove(int mx, int my) {
+        hoverBtn = -1;
+        hoverChallenge = pointInRect(mx, my, challengeBtn);
+        hoverPacing = pointInRect(mx, my, pacingBtn);
+        hoverPattern = pointInRect(mx, my, patternBtn);
+        hoverTargets = pointInRect(mx, my, targetsBtn);
+        if (pointInRect(mx, my, applyBtn))hoverBtn = 1;
+        else if (pointInRect(mx, my, resetBtn))hoverBtn = 2;
+
+        if (dragging == 1) {
+            float n = (mx - sensBar.x) / float(sensBar.w);
+            n = CLAMP(n, 0.f, 1.f);
+            float lm = log10f(0.001f), lM = log10f(3.0f);
+            sensVal = powf(10.0f, lm + n * (lM - lm));
+            updateKnobs();
+        }
+        if (dragging == 2) {
+            float n = (mx - fovBar.x) / float(fovBar.w);
+            n = CLAMP(n, 0.f, 1.f);
+            fovVal = 60.0f + n * 70.0f;
+            updateKnobs();
+        }
+        auto setVal = [&](int code, int mx, const Rect& bar, int& out, float mn, float mxv) {
+            if (dragging != code)return;
+            float n = (mx - bar.x) / float(bar.w);
+            n = CLAMP(n, 0.f, 1.f);
+            out = int(mn + n * (mxv - mn));
+            updateKnobs();
+            };
+        setVal(3, mx, gapBar, gapVal, 0.0f, 50.0f);
+        setVal(4, mx, lenBar, lenVal, 0.0f, 100.0f);
+        setVal(5, mx, rBar, rVal, 0.0f, 255.0f);
+        setVal(6, mx, gBar, gVal, 0.0f, 255.0f);
+        setVal(7, mx, bBar, bVal, 0.0f, 255.0f);
+        setVal(8, mx, capBar, capVal, float(MIN_FPS_CAP), float(MAX_FPS_CAP));
+    }
+
+    void apply() {
+        config.sensitivity = sensVal;
+        config.fov = fovVal;
+        config.cross_gap = gapVal;
+        config.cross_len = lenVal;
+        config.cross_r = rVal;
+        config.cross_g = gVal;
+        config.cross_b = bVal;
+        config.challengeMode = challengeVal;
+        syncLiveContext();
+        config.fpsCap = capVal;
+        config.pacingMode = pacingVal;
+        config.trackPattern = patternVal;
+        config.trackTargets = targetsVal;
+        persist.saveConfig(config);
+    }
+
+    void reset() {
+        sensVal = config.sensitivity;
+        fovVal = config.fov;
+        gapVal = config.cross_gap;
+        lenVal = config.cross_len;
+        rVal = config.cross_r;
+        gVal = config.cross_g;
+        bVal = config.cross_b;
+        challengeVal = config.challengeMode;
+        capVal = config.fpsCap;
+        pacingVal = config.pacingMode;
+        patternVal = config.trackPattern;
+        targetsVal = config.trackTargets;
+        updateKnobs();
+    }
+
+    void render(SDL_Renderer* ren) {
+        clearScreen(ren);
+        uiScale(ren);
+        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
+        // FPS cap
+        drawText(ren,
+            capBar.x, capBar.y - 15, "Frame Rate Cap");
+        drawRect(ren,
+            capBar.x, capBar.y, capBar.w, capBar.h, { 200,200,200,255 });
+        drawRect(ren,
+            capKnob.x, capKnob.y, capKnob.w, capKnob.h, { 255,255,255,255 });
+        drawText(ren,
+            capBar.x + capBar.w + 10, capBar.y - 4, capTxt);
+        // Sensitivity
+        drawText(ren,
+            sensBar.x, sensBar.y - 15, "Mouse Sensitivity");
+        drawRect(ren,
+            sensBar.x, sensBar.y, sensBar.w, sensBar.h, { 200,200,200,255 });
+        drawRect(ren,
+            sensKnob.x, sensKnob.y, sensKnob.w, sensKnob.h, { 255,255,255,255 });
+        drawText(ren,
+            sensBar.x + sensBar.w + 10, sensBar.y - 4, sensTxt);
+        // FOV
+        drawText(ren,
+            fovBar.x, fovBar.y - 15, "Field of View");
+        drawRect(ren,
+            fovBar.x, fovBar.y, fovBar.w, fovBar.h, { 200,200,200,255 });
+        drawRect(ren,
+            fovKnob.x, fovKnob.y, fovKnob.w, fovKnob.h, { 255,255,255,255 });
+        drawText(ren,
+            fovBar.x + fovBar.w + 10, fovBar.y - 4, fovTxt);
+        // Gap
+        drawText(ren,
+            gapBar.x, gapBar.y - 15, "Crosshair Gap");
+        drawRect(ren,
+            gapBar.x, gapBar.y, gapBar.w, gapBar.h, { 200,200,200,255 });
+        drawRect(ren,
+            gapKnob.x, gapKnob.y, gapKnob.w, gapKnob.h, { 255,255,255,255 });
+        drawText(ren,
+            gapBar.x + gapBar.w + 10, gapBar.y - 4, gapTxt);
+        // Length
+        drawText(ren,
+            lenBar.x, lenBar.y - 15, "Crosshair Length");
+        drawRect(ren,
+            lenBar.x, lenBar.y, lenBar.w, lenBar.h, { 200,200,200,255 });
+        drawRect(ren,
+            lenKnob.x, lenKnob.y, lenKnob.w, lenKnob.h, { 255,255,255,255 });
+        drawText(ren,
+            lenBar.x + lenBar.w + 10, lenBar.y - 4, lenTxt);
+        // R
+        drawText(ren,
+            rBar.x, rBar.y - 15, "Crosshair R");
+        drawRect(ren,
+            rBar.x, rBar.y, rBar.w, rBar.h, { 200,200,200,255 });
+        drawRect(ren,
+            rKnob.x, rKnob.y, rKnob.w, rKnob.h, { 255,255,255,255 });
+        drawText(ren,
+            rBar.x + rBar.w + 10, rBar.y - 4, rTxt);
+        // G
+        drawText(ren,
+            gBar.x, gBar.y - 15, "Crosshair G");
+        drawRect(ren,
+            gBar.x, gBar.y, gBar.w, gBar.h, { 200,200,200,255 });
+        drawRect(ren,
+            gKnob.x, gKnob.y, gKnob.w, gKnob.h, { 255,255,255,255 });
+        drawText(ren,
+            gBar.x + gBar.w + 10, gBar.y - 4, gTxt);
+        // B
+        drawText(ren,
+            bBar.x, bBar.y - 15, "Crosshair B");
+        drawRect(ren,
+            bBar.x, bBar.y, bBar.w, bBar.h, { 200,200,200,255 });
+        drawRect(ren,
+            bKnob.x, bKnob.y, bKnob.w, bKnob.h, { 255,255,255,255 });
+        drawText(ren,
+            bBar.x + bBar.w + 10, bBar.y - 4, bTxt);
+        // Challenge Mode toggle
+        SDL_Color baseBtn{ 100,100,100,255 }, hovBtn{ 150,150,150,255 };
+        drawRect(ren,
+            challengeBtn.x, challengeBtn.y,
+            challengeBtn.w, challengeBtn.h,
+            hoverChallenge ? hovBtn : baseBtn);
+        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
+        drawText(ren,
+            challengeBtn.x + 10, challengeBtn.y + 10, challengeTxt);
+        // Frame pacing mode
+        drawRect(ren,
+            pacingBtn.x, pacingBtn.y,
+            pacingBtn.w, pacingBtn.h,
+            hoverPacing ? hovBtn : baseBtn);
+        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
+        drawText(ren,
+            pacingBtn.x + 10, pacingBtn.y + 10, pacingTxt);
+        // Tracking drill
+        drawRect(ren,
+            patternBtn.x, patternBtn.y,
+            patternBtn.w, patternBtn.h,
+            hoverPattern ? hovBtn : baseBtn);
+        drawRect(ren,
+            targetsBtn.x, targetsBtn.y,
+            targetsBtn.w, targetsBtn.h,
+            hoverTargets ? hovBtn : baseBtn);
+        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
+        drawText(ren,
+            patternBtn.x + 10, patternBtn.y + 10, patternTxt);
+        drawText(ren,
+            targetsBtn.x + 10, targetsBtn.y + 10, targetsTxt);
+        // Apply & Reset
+        drawRect(ren,
+            applyBtn.x, applyBtn.y,
+            applyBtn.w, applyBtn.h,
+            hoverBtn == 1 ? hovBtn : baseBtn);
+        drawRect(ren,
+            resetBtn.x, resetBtn.y,
+            resetBtn.w, resetBtn.h,
+            hoverBtn == 2 ? hovBtn : baseBtn);
+        drawText(ren,
+            applyBtn.x + 20, applyBtn.y + 10, "Apply");
+        drawText(ren,
+            resetBtn.x + 20, resetBtn.y + 10, "Reset");
+    }
+};
+
+// --- CreditsScreen ---
+class CreditsScreen {
+public:
+    void render(SDL_Renderer* ren) {
+        clearScreen(ren);
+        uiScale(ren);
+        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
+        int mx = view.uiW() / 2, my = view.uiH() / 2;
+        drawText(ren,
+            mx - 50, my - 4,
+            "FPS Aim Trainer v1.0");
+        drawText(ren,
+            mx - 80, my + 12,
+            "by Xavier Seron, Ceaser Fandino, David Rodriguez");
+        drawText(ren,
+            mx - 60, my + 40,
+            "(Click or press any key)");
+    }
+};
+
+// --- StatsScreen ---
+// Per-mode trends from ScoreLog's analytics. Text is reformatted only when
+// the mode tab or the session count changes; nothing here walks history.
+class StatsScreen {
+public:
+    Rect tabs[MODE_COUNT], backBtn, chart;
+    int mode = MODE_GRIDSHOT, hover = -1;   // hover: tab index, MODE_COUNT = back
+    static const int MAX_LINES = 32;
+    char lines[MAX_LINES][96], caption[64] = "";
+    int lineCount = 0;
+    Uint64 shownCount = ~0ull;
+    int shownMode = -1;
+    const ScoreLog* log = &scoreLog;
+
+    StatsScreen() { layout(); }
+    void layout() {
+        for (int m = 0;m < MODE_COUNT;++m)
+            tabs[m] = { 80 + m * 130, 60, 120, 30 };
+        backBtn = { view.uiW() - 200, view.uiH() - 70, 120, 30 };
+        chart = { view.uiW() / 2 + 40, 120, view.uiW() / 2 - 120, 260 };
+    }
+    void handleMouseMove(int mx, int my) {
+        hover = pointInRect(mx, my, backBtn) ? MODE_COUNT : -1;
+        for (int m = 0;m < MODE_COUNT;++m)
+            if (pointInRect(mx, my, tabs[m])) hover = m;
+    }
+    // returns true when Back was clicked
+    bool handleMouseDown(int mx, int my) {
+        for (int m = 0;m < MODE_COUNT;++m)
+            if (pointInRect(mx, my, tabs[m])) mode = m;
+        return pointInRect(mx, my, backBtn);
+    }
+    void cycleMode(int dir) { mode = (mode + dir + MODE_COUNT) % MODE_COUNT; }
+
+    void refresh() {
+        const SessionAnalytics& a = log->analytics[mode];
+        const ScoreLog::Stats& st = log->stats[mode];
+        shownMode = mode;
+        shownCount = a.count;
+        lineCount = 0;
+        auto line = [&](const char* fmt, auto... args) {
+            if (lineCount < MAX_LINES) snprintf(lines[lineCount++], sizeof(lines[0]), fmt, args...);
+            };
+        snprintf(caption, sizeof(caption), "mean per %llu sessions; lines: p10/p50/p90",
+            (unsigned long long)a.sessionsPerTrendPoint());
+        if (!a.count) { line("No %s sessions yet.", MODE_NAMES[mode]); return; }
+        line("Sessions: %llu   Best: %.2f   Mean: %.2f",
+            (unsigned long long)a.count, st.best, st.mean());
+        line("Moving average: last ~10 %.2f   last ~100 %.2f", a.emaShort, a.emaLong);
+        line("Percentile band (all time): p10 %.2f  p50 %.2f  p90 %.2f",
+            a.q10.value(), a.q50.value(), a.q90.value());
+        line("Percentile band (last %d):  p10 %.2f  p50 %.2f  p90 %.2f", int(st.sorted.size()),
+            st.percentile(0.1), st.percentile(0.5), st.percentile(0.9));
+        line("Improvement: %+.3f per 100 sessions", a.slope() * 100.0);
+        line("");
+        line("Sensitivity      runs     mean     best");
+        for (int b = 0;b < SessionAnalytics::BUCKETS;++b)
+            if (a.bySens[b].count)
+                line("%-12s %8llu %8.2f %8.2f", SessionAnalytics::sensLabel(b),
+                    (unsigned long long)a.bySens[b].count, a.bySens[b].mean(), a.bySens[b].best);
+        line("");
+        line("FOV              runs     mean     best");
+        for (int b = 0;b < SessionAnalytics::BUCKETS;++b)
+            if (a.byFov[b].count)
+                line("%-12s %8llu %8.2f %8.2f", SessionAnalytics::fovLabel(b),
+                    (unsigned long long)a.byFov[b].count, a.byFov[b].mean(), a.byFov[b].best);
+    }
+
+    void render(SDL_Renderer* ren) {
+        const SessionAnalytics& a = log->analytics[mode];
+        if (mode != shownMode || a.count != shownCount) refresh();
+        clearScreen(ren);
+        uiScale(ren);
+        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
+        drawText(ren, 80, 30, "STATISTICS");
+        SDL_Color base{ 80,80,80,255 }, hov{ 100,100,100,255 }, sel{ 60,90,140,255 };
+        for (int m = 0;m < MODE_COUNT;++m) {
+            drawRect(ren, tabs[m].x, tabs[m].y, tabs[m].w, tabs[m].h,
+                m == mode ? sel : hover == m ? hov : base);
+            drawText(ren, tabs[m].x + tabs[m].w / 2 - (int)strlen(MODE_NAMES[m]) * 4,
+                tabs[m].y + tabs[m].h / 2 - 4, MODE_NAMES[m]);
+        }
+        for (int i = 0;i < lineCount;++i)
+            drawText(ren, 80, 120 + i * 16, lines[i]);
+        drawRect(ren, backBtn.x, backBtn.y, backBtn.w, backBtn.h,
+            hover == MODE_COUNT ? hov : base);
+        drawText(ren, backBtn.x + backBtn.w / 2 - 16, backBtn.y + backBtn.h / 2 - 4, "Back");
+
+        // trend chart: mean score per trend point, p10/p50/p90 as lines
+        SDL_Color frame{ 60,60,60,255 }, bar{ 70,160,90,255 }, band{ 150,150,150,255 };
+        drawRect(ren, chart.x, chart.y, chart.w, 1, frame);
+        drawRect(ren, chart.x, chart.y + chart.h, chart.w, 1, frame);
+        if (a.trendLen < 1) return;
+        double lo = std::min<double>(a.q10.value(), *std::min_element(a.trend, a.trend + a.trendLen));
+        double hi = std::max<double>(a.q90.value(), *std::max_element(a.trend, a.trend + a.trendLen));
+        if (hi - lo < 1e-9) { lo -= 1; hi += 1; }
+        auto yOf = [&](double v) { return chart.y + chart.h - int((v - lo) / (hi - lo) * chart.h); };
+        int bw = std::max(1, chart.w / SessionAnalytics::TREND_POINTS);
+        for (int i = 0;i < a.trendLen;++i) {
+            int y = yOf(a.trend[i]);
+            drawRect(ren, chart.x + i * bw, y, std::max(1, bw - 1), chart.y + chart.h - y, bar);
+        }
+        const double qs[3] = { a.q10.value(), a.q50.value(), a.q90.value() };
+        for (double q : qs) drawRect(ren, chart.x, yOf(q), chart.w, 1, band);
+        drawText(ren, chart.x, chart.y + chart.h + 10, caption);
+    }
+};
+
+// --- DrillMenu ---
+// Pages through the custom drills from Scenarios::Library; clicking a row
+// starts it. Row text is formatted when the page or the list changes.
+class DrillMenu {
+public:
+    static const int MAX_ROWS = 24, ROW_H = 34;
+    Rect rows[MAX_ROWS], prevBtn, nextBtn, backBtn;
+    int perPage = 1, page = 0, hover = -1;   // hover: row, MAX_ROWS + 0/1/2 = prev/next/back
+    char labels[MAX_ROWS][112], title[96] = "";
+    const std::vector<Scenario>* drills = nullptr;
+
+    DrillMenu() { layout(); }
+    void layout() {
+        perPage = CLAMP((view.uiH() - 180) / ROW_H, 1, MAX_ROWS);
+        int w = 880, x = view.uiW() / 2 - w / 2;
+        for (int i = 0;i < MAX_ROWS;++i) rows[i] = { x, 80 + i * ROW_H, w, ROW_H - 6 };
+        int by = 80 + perPage * ROW_H + 10;
+        prevBtn = { x, by, 120, 30 };
+        backBtn = { x + w / 2 - 60, by, 120, 30 };
+        nextBtn = { x + w - 120, by, 120, 30 };
+        setPage(page);
+    }
+    void setDrills(const std::vector<Scenario>& d) {
+        drills = &d;
+        setPage(page);
+    }
+    int pages() const { return drills ? std::max(1, (int(drills->size()) + perPage - 1) / perPage) : 1; }
+    void cyclePage(int dir) { setPage(page + dir); }
+    void setPage(int p) {
+        page = CLAMP(p, 0, pages() - 1);
+        int total = drills ? int(drills->size()) : 0;
+        if (!total) snprintf(title, sizeof(title), "No drills in %s/ (F5 reloads)", SCENARIO_DIR);
+        else snprintf(title, sizeof(title), "CUSTOM DRILLS   page %d/%d   (F5 reloads)", page + 1, pages());
+        for (int i = 0;i < perPage;++i) {
+            int k = page * perPage + i;
+            if (k >= total) { labels[i][0] = 0; continue; }
+            const Scenario& s = (*drills)[k];
+            char detail[48];
+            if (s.mode == MODE_GRIDSHOT)
+                snprintf(detail, sizeof(detail), "%dx%d grid, %d live", s.gridCols, s.gridRows, s.targets);
+            else if (s.mode == MODE_TRACKING)
+                snprintf(detail, sizeof(detail), "%s x%d, %.0f deg/s", MOTION_NAMES[s.pattern], s.targets, s.speed);
+            else
+                snprintf(detail, sizeof(detail), "%d targets", s.targets);
+            snprintf(labels[i], sizeof(labels[0]), "%-31s %-8s %4ds  %s",
+                s.name, MODE_NAMES[s.mode], s.durationMs / 1000, detail);
+        }
+    }
+    void handleMouseMove(int mx, int my) {
+        hover = pointInRect(mx, my, prevBtn) ? MAX_ROWS
+            : pointInRect(mx, my, nextBtn) ? MAX_ROWS + 1
+            : pointInRect(mx, my, backBtn) ? MAX_ROWS + 2 : -1;
+        for (int i = 0;i < perPage;++i)
+            if (labels[i][0] && pointInRect(mx, my, rows[i])) hover = i;
+    }
+    // the clicked drill, or null; back is set when Back was clicked
+    const Scenario* handleMouseDown(int mx, int my, bool& back) {
+        back = pointInRect(mx, my, backBtn);
+        if (pointInRect(mx, my, prevBtn)) cyclePage(-1);
+        if (pointInRect(mx, my, nextBtn)) cyclePage(1);
+        for (int i = 0;i < perPage;++i)
+            if (labels[i][0] && pointInRect(mx, my, rows[i]))
+                return &(*drills)[page * perPage + i];
+        return nullptr;
+    }
+
+    void render(SDL_Renderer* ren) {
+        clearScreen(ren);
+        uiScale(ren);
+        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
+        drawText(ren, rows[0].x, 40, title);
+        SDL_Color base{ 80,80,80,255 }, hov{ 100,100,100,255 };
+        for (int i = 0;i < perPage && labels[i][0];++i) {
+            drawRect(ren, rows[i].x, rows[i].y, rows[i].w, rows[i].h, hover == i ? hov : base);
+            drawText(ren, rows[i].x + 10, rows[i].y + rows[i].h / 2 - 4, labels[i]);
+        }
+        const Rect* btns[3] = { &prevBtn, &nextBtn, &backBtn };
+        const char* names[3] = { "Prev", "Next", "Back" };
+        for (int b = 0;b < 3;++b) {
+            drawRect(ren, btns[b]->x, btns[b]->y, btns[b]->w, btns[b]->h,
+                hover == MAX_ROWS + b ? hov : base);
+            drawText(ren, btns[b]->x + btns[b]->w / 2 - (int)strlen(names[b]) * 4,
+                btns[b]->y + btns[b]->h / 2 - 4, names[b]);
+        }
+    }
+};
+
+// --- Score distributions ---
+// n, mean, sample sd and interpolated 10/50/90th percentiles of a set of
+// session scores (sorts them).
+struct ScoreStats {
+    size_t n = 0;
+    double mean = 0, sd = 0, p10 = 0, p50 = 0, p90 = 0;
+
+    explicit ScoreStats(std::vector<double>& scores) {
+        n = scores.size();
+        if (!n) return;
+        std::sort(scores.begin(), scores.end());
+        double var = 0;
+        for (double s : scores) mean += s;
+        mean /= n;
+        for (double s : scores) var += (s - mean) * (s - mean);
+        sd = n > 1 ? sqrt(var / (n - 1)) : 0;
+        auto pct = [&](double p) {
+            double x = p * (n - 1);
+            size_t i = size_t(x);
+            return i + 1 < n ? scores[i] + (scores[i + 1] - scores[i]) * (x - i) : scores[i];
+        };
+        p10 = pct(0.1); p50 = pct(0.5); p90 = pct(0.9);
+    }
+};
+
+// --- Simulated player ---
+// Plays a session the way a person would, for unattended soak runs and for
+// expected-score distributions per drill. It sees the targets through
+// GameMode::listTargets and answers with what a 1 kHz mouse reports: whole
+// motion counts (the fraction is carried) and left clicks, which the caller
+// feeds through the normal input path.
+//  - click drills: pick the nearest target, wait a lognormal reaction time,
+//    then flick with a minimum-jerk submovement lasting a + b*log2(D/W + 1)
+//    ms (Fitts's law, W = target width) that ends over or short of the
+//    target in proportion to D; corrective submovements follow until the
+//    aim rests on the target, then a click after a short settle
+//  - tracking: smooth pursuit on what was seen trackLag ago: the hand moves
+//    at trackLead of the target's velocity, aims trackLead of the lag ahead
+//    of its position and closes the remaining error at trackGain/s
+// Slow drift and per-sample tremor ride on top of the hand, and the player
+// judges and corrects from where the aim really is.
+class SimPlayer {
+public:
+    struct Skill {
+        const char* name;
+        double reactionMs, reactionSpread;   // lognormal median (ms) and log sd
+        double fittsA, fittsB;               // ms, ms per bit
+        double overshoot, endpointSd;        // flick endpoint error, fraction of distance
+        double correctionMs;                 // pause before a corrective submovement
+        double clickMs;                      // on target -> click
+        double trackLagMs, trackGain, trackLead;
+        double driftDeg, tremorDeg;          // slow wander and per-sample noise (sd)
+    };
+    static constexpr int SKILL_COUNT = 4;
+    static constexpr Skill SKILLS[SKILL_COUNT] = {
+        { "novice",  280, 0.25, 120, 190, 0.10, 0.16, 190, 130, 180,  5.0, 0.65, 0.35, 0.030 },
+        { "average", 240, 0.20,  90, 150, 0.06, 0.11, 150,  95, 140,  6.0, 0.70, 0.25, 0.020 },
+        { "skilled", 205, 0.16,  60, 115, 0.04, 0.08, 120,  65, 105,  9.0, 0.80, 0.15, 0.012 },
+        { "pro",     180, 0.12,  40,  90, 0.02, 0.05, 100,  45,  80, 12.0, 0.90, 0.08, 0.007 },
+    };
+    static const Skill* findSkill(const char* name) {
+        for (const Skill& s : SKILLS)
+            if (strcmp(s.name, name) == 0) return &s;
+        return nullptr;
+    }
+    static const Uint64 POLL_NS = SDL_NS_PER_SECOND / 1000;
+
+    // One line per drill/skill cell.
+    static void printScores(const char* label, std::vector<double>& scores) {
+        if (scores.empty()) return;
+        ScoreStats st(scores);
+        printf("%-36s n %5zu  mean %8.2f  sd %7.2f  p10 %8.2f  p50 %8.2f  p90 %8.2f\n",
+            label, st.n, st.mean, st.sd, st.p10, st.p50, st.p90);
+    }
+
+    // Starts a session: the hand rests at camYaw/camPitch and nothing is
+    // emitted before startNS (the end of the countdown).
+    void begin(const Skill& s, Uint64 seed, bool tracking, float sensitivity, Uint64 startNS,
+        double camYaw, double camPitch) {
+        skill = s;
+        rng.seed(seed);
+        this->tracking = tracking;
+        sens = sensitivity;
+        lastNS = startNS;
+        handYaw = outYaw = camYaw;
+        handPitch = outPitch = camPitch;
+        driftYaw = driftPitch = 0;
+        phase = IDLE;
+        target = -1;
+        polls = 0;
+    }
+
+    // Takes the camera as the truth again (input the mode dropped, a hand
+    // on the real mouse) by shifting the hand by the difference.
+    void sync(double camYaw, double camPitch) {
+        double dy = remainder(camYaw - outYaw, 360.0), dp = camPitch - outPitch;
+        outYaw += dy; handYaw += dy; fromYaw += dy; toYaw += dy;
+        outPitch += dp; handPitch += dp; fromPitch += dp; toPitch += dp;
+    }
+
+    // Moves the hand up to toNS against the current targets, calling
+    // emit(timeNS, SDL event type, xrel, yrel) for every motion and click.
+    template<class Emit>
+    void advance(Uint64 toNS, const std::vector<TargetInfo>& targets, Emit&& emit) {
+        stale = false;
+        while (lastNS + POLL_NS <= toNS) {
+            lastNS += POLL_NS;
+            bool click = false;
+            if (tracking) pursue(targets);
+            else flick(targets, click);
+            // drift: Ornstein-Uhlenbeck with a 250 ms time constant
+            const double a = exp(-double(POLL_NS) / 250e6), w = skill.driftDeg * sqrt(1 - a * a);
+            driftYaw = driftYaw * a + w * rng.normal();
+            driftPitch = driftPitch * a + w * rng.normal();
+            // same float product applyMouseMotion uses, so outYaw/outPitch
+            // follow the camera exactly
+            double ty = handYaw + driftYaw + skill.tremorDeg * rng.normal();
+            double tp = handPitch + driftPitch + skill.tremorDeg * rng.normal();
+            float dx = float(lround((ty - outYaw) / sens));
+            float dy = float(lround((outPitch - tp) / sens));
+            if (dx != 0 || dy != 0) {
+                emit(lastNS, Uint32(SDL_EVENT_MOUSE_MOTION), dx, dy);
+                outYaw += dx * sens;
+                outPitch -= dy * sens;
+            }
+            if (click) {
+                emit(lastNS, Uint32(SDL_EVENT_MOUSE_BUTTON_DOWN), 0.0f, 0.0f);
+                stale = true;   // targets only refresh with the next call
+            }
+        }
+    }
+
+private:
+    enum Phase { IDLE, REACT, MOVE, SETTLE };
+    static const int HISTORY = 1024;   // tracking samples, one per poll
+    Skill skill = SKILLS[1];
+    Rng rng;
+    bool tracking = false, stale = false;
+    float sens = 1.0f;   // deg per count, as the mode applies it
+    Uint64 lastNS = 0, until = 0, moveStart = 0, moveNS = 1;
+    Phase phase = IDLE;
+    double handYaw = 0, handPitch = 0;   // intended aim, yaw unwrapped
+    double driftYaw = 0, driftPitch = 0;
+    double outYaw = 0, outPitch = 0;     // where the emitted counts put the camera
+    double goalYaw = 0, goalPitch = 0, goalRad = 1;
+    double fromYaw = 0, fromPitch = 0, toYaw = 0, toPitch = 0;
+    int target = -1;
+    Uint32 polls = 0;
+    float histYaw[HISTORY], histPitch[HISTORY];
+
+    static Uint64 ms(double v) { return Uint64(std::max(v, 1.0) * 1e6); }
+    // a target yaw unwrapped to the side the aim is on
+    double nearYaw(double yaw) const { return outYaw + remainder(yaw - outYaw, 360.0); }
+
+    int nearest(const std::vector<TargetInfo>& tg) const {
+        int best = -1;
+        double bestD = 1e30;
+        for (size_t i = 0;i < tg.size();++i) {
+            double dy = nearYaw(tg[i].yaw) - outYaw, dp = tg[i].pitch - outPitch;
+            double d = dy * dy + dp * dp;
+            if (d < bestD) { bestD = d; best = int(i); }
+        }
+        return best;
+    }
+
+    void react(double medianMs, double spread) {
+        phase = REACT;
+        until = lastNS + ms(medianMs * exp(spread * rng.normal()));
+    }
+
+    // Plans a submovement from the aim to the goal: Fitts's-law duration,
+    // endpoint off by a gain error along the path and scatter across it.
+    void plan() {
+        double dy = goalYaw - outYaw, dp = goalPitch - outPitch;
+        double d = sqrt(dy * dy + dp * dp);
+        double mt = skill.fittsA + skill.fittsB * log2(d / (2 * goalRad) + 1);
+        double gain = 1 + skill.overshoot + skill.endpointSd * rng.normal();
+        double side = 0.5 * skill.endpointSd * rng.normal();
+        fromYaw = handYaw; fromPitch = handPitch;
+        toYaw = handYaw + dy * gain - dp * side;
+        toPitch = handPitch + dp * gain + dy * side;
+        moveStart = lastNS;
+        moveNS = ms(mt);
+        phase = MOVE;
+    }
+
+    void flick(const std::vector<TargetInfo>& tg, bool& click) {
+        switch (phase) {
+        case IDLE: {
+            int k = stale ? -1 : nearest(tg);
+            if (k < 0) return;
+            goalYaw = nearYaw(tg[k].yaw);
+            goalPitch = tg[k].pitch;
+            goalRad = tg[k].rad;
+            react(skill.reactionMs, skill.reactionSpread);
             return;
         }
-        double dy = yaw - cy; if (dy > 180) dy -= 360; else if (dy < -180) dy += 360;
-        double dp = pitch - cp;
-        double hF = config.fov, asp = double(WINDOW_WIDTH) / WINDOW_HEIGHT;
-        double vF = (180.0 / M_PI) * 2 * atan(
-            tan(hF * M_PI / 180.0 / 2) * (1.0 / asp));
-        if (fabs(dy) <= hF / 2 && fabs(dp) <= vF / 2) {
-            double xN = tan(dy * M_PI / 180.0) / tan(hF * M_PI / 180.0 / 2);
-            double yN = tan(dp * M_PI / 180.0) / tan(vF * M_PI / 180.0 / 2);
-            int x = int(xN * (WINDOW_WIDTH / 2) + WINDOW_WIDTH / 2);
-            int y = int(-yN * (WINDOW_HEIGHT / 2) + WINDOW_HEIGHT / 2);
-            drawRect(ren,
-                x - targPixRad, y - targPixRad,
-                2 * targPixRad, 2 * targPixRad,
-                tgtCol);
+        case REACT:
+            if (lastNS >= until) plan();
+            return;
+        case MOVE: {
+            double u = std::min(1.0, double(lastNS - moveStart) / moveNS);
+            double s = u * u * u * (10 + u * (-15 + 6 * u));   // minimum jerk
+            handYaw = fromYaw + (toYaw - fromYaw) * s;
+            handPitch = fromPitch + (toPitch - fromPitch) * s;
+            if (u < 1) return;
+            double r = 0.9 * goalRad;
+            if (fabs(outYaw - goalYaw) < r && fabs(outPitch - goalPitch) < r) {
+                phase = SETTLE;
+                until = lastNS + ms(skill.clickMs * exp(0.3 * rng.normal()));
+            }
+            else react(skill.correctionMs, 0.2);
+            return;
+        }
+        case SETTLE:
+            if (lastNS < until) return;
+            click = true;
+            phase = IDLE;
+            return;
         }
-        SDL_Color cc{ (Uint8)config.cross_r,
-                     (Uint8)config.cross_g,
-                     (Uint8)config.cross_b,255 };
-        int gap = config.cross_gap, len = config.cross_len;
-        drawLine(ren, WINDOW_WIDTH / 2 - len, WINDOW_HEIGHT / 2,
-            WINDOW_WIDTH / 2 - gap, WINDOW_HEIGHT / 2, cc);
-        drawLine(ren, WINDOW_WIDTH / 2 + gap, WINDOW_HEIGHT / 2,
-            WINDOW_WIDTH / 2 + len, WINDOW_HEIGHT / 2, cc);
-        drawLine(ren, WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2 - len,
-            WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2 - gap, cc);
-        drawLine(ren, WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2 + gap,
-            WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2 + len, cc);
-        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
-        char hud[64];
-        sprintf(hud, "OnTarget:%.1fs Best:%.1fs Time:%ds",
-            score, best, timeRem / 1000);
-        SDL_RenderDebugText(ren, 10, 10, hud);
-        if (challengeMode)
-            SDL_RenderDebugText(ren, 10, 30, "CHALLENGE MODE");
     }
-    void toggleChallengeMode() override {
-        challengeMode = !challengeMode;
+
+    void pursue(const std::vector<TargetInfo>& tg) {
+        if (tg.empty()) return;
+        if (target < 0 || target >= int(tg.size())) {
+            target = nearest(tg);
+            react(skill.reactionMs, skill.reactionSpread);
+            polls = 0;
+        }
+        const TargetInfo& t = tg[target];
+        histYaw[polls % HISTORY] = float(t.yaw);
+        histPitch[polls % HISTORY] = float(t.pitch);
+        ++polls;
+        if (lastNS < until) return;
+        // what the eye has seen: the target lagMs ago and its velocity then
+        Uint32 lag = std::min(Uint32(skill.trackLagMs), polls - 1);
+        Uint32 back = std::min(Uint32(20), polls - 1 - lag);
+        Uint32 a = (polls - 1 - lag) % HISTORY, b = (polls - 1 - lag - back) % HISTORY;
+        double vy = back ? remainder(double(histYaw[a]) - histYaw[b], 360.0) / back : 0;
+        double vp = back ? (double(histPitch[a]) - histPitch[b]) / back : 0;
+        double lead = skill.trackLead * skill.trackLagMs;
+        double gy = nearYaw(histYaw[a] + vy * lead), gp = histPitch[a] + vp * lead;
+        double k = 1 - exp(-skill.trackGain * POLL_NS / 1e9);
+        handYaw += skill.trackLead * vy + (gy - outYaw) * k;
+        handPitch += skill.trackLead * vp + (gp - outPitch) * k;
     }
 };
 
-// --- SettingsMenu ---
-class SettingsMenu {
+// --- Headless simulation ---
+// Runs the modes from a scripted input stream without a window or renderer.
+// Event times are ns since start() (countdown included); like the live loop,
+// each tick takes the events that happened up to its end.
+namespace HeadlessSim {
+    enum EventType { MOTION, CLICK };
+    struct Event {
+        Uint64 timeNS;
+        EventType type;
+        float xrel, yrel;
+    };
+
+    static void click(GridshotMode& m, Uint64 intoTickNS, double cy, double cp) { m.handleClick(cy, cp, intoTickNS); }
+    static void click(TrackingMode&, Uint64, double, double) {}
+    static void click(SwarmMode& m, Uint64 intoTickNS, double cy, double cp) { m.handleClick(cy, cp, intoTickNS); }
+    // only TrackingMode scores between ticks
+    template<class Mode>
+    static void aim(Mode&, Uint64, double, double) {}
+    static void aim(TrackingMode& m, Uint64 intoTickNS, double cy, double cp) { m.aim(intoTickNS, cy, cp); }
+
+    template<class Mode>
+    double runSession(Mode& mode, const std::vector<Event>& script,
+        Uint64 tickNS = SDL_NS_PER_SECOND / 1000) {
+        double camYaw = 0, camPitch = 0;
+        Uint64 now = 0;
+        size_t next = 0;
+        mode.start();
+        while (mode.isRunning()) {
+            while (next < script.size() && script[next].timeNS <= now + tickNS) {
+                const Event& e = script[next++];
+                Uint64 into = e.timeNS > now ? e.timeNS - now : 0;
+                if (mode.isInCountdown(into)) continue;
+                if (e.type == MOTION) {
+                    applyMouseMotion(camYaw, camPitch, e.xrel, e.yrel, mode.ctx->sensitivity);
+                    aim(mode, into, camYaw, camPitch);
+                }
+                else click(mode, into, camYaw, camPitch);
+            }
+            mode.update(tickNS, camYaw, camPitch);
+            now += tickNS;
+        }
+        return mode.getScore();
+    }
+
+    // Closed loop with a SimPlayer: each tick the player sees the targets as
+    // they stand at the tick's start, and its input for the tick is applied
+    // the way runSession applies a script.
+    template<class Mode>
+    double runPlayer(Mode& mode, SimPlayer& player, const SimPlayer::Skill& skill,
+        Uint64 seed, Uint64 tickNS = SDL_NS_PER_SECOND / 1000) {
+        double camYaw = 0, camPitch = 0;
+        Uint64 now = 0;
+        std::vector<TargetInfo> targets;
+        mode.seed(seed);
+        mode.start();
+        player.begin(skill, ~seed, mode.scenario.mode == MODE_TRACKING, mode.ctx->sensitivity,
+            SDL_MS_TO_NS(mode.scenario.countdownMs), camYaw, camPitch);
+        while (mode.isRunning()) {
+            if (!mode.isInCountdown(tickNS)) {
+                mode.listTargets(camYaw, camPitch, targets);
+                player.advance(now + tickNS, targets, [&](Uint64 t, Uint32 type, float xrel, float yrel) {
+                    Uint64 into = t > now ? t - now : 0;
+                    if (mode.isInCountdown(into)) return;
+                    if (type == SDL_EVENT_MOUSE_MOTION) {
+                        applyMouseMotion(camYaw, camPitch, xrel, yrel, mode.ctx->sensitivity);
+                        aim(mode, into, camYaw, camPitch);
+                    }
+                    else click(mode, into, camYaw, camPitch);
+                    });
+            }
+            mode.update(tickNS, camYaw, camPitch);
+            now += tickNS;
+        }
+        return mode.getScore();
+    }
+
+    // Deterministic pseudo-random script: motion at motionHz, a click every
+    // clickMs, for totalMs (countdown included).
+    static std::vector<Event> makeScript(Uint32 seed, Uint32 motionHz, Uint32 clickMs,
+        Uint32 total = COUNTDOWN_DURATION_MS + GAME_DURATION_MS) {
+        std::vector<Event> out;
+        Uint32 motionMs = motionHz ? CLAMP(1000 / motionHz, 1u, 1000u) : total + 1;
+        out.reserve(total / motionMs + total / clickMs + 2);
+        Uint32 nextClick = clickMs;
+        for (Uint32 t = 0; t <= total; t += motionMs) {
+            seed = seed * 1664525u + 1013904223u;
+            float xr = float(int(seed >> 24) - 128) / 8.0f;
+            float yr = float(int((seed >> 16) & 0xff) - 128) / 16.0f;
+            out.push_back({ SDL_MS_TO_NS(t), MOTION, xr, yr });
+            while (nextClick <= t) {
+                out.push_back({ SDL_MS_TO_NS(nextClick), CLICK, 0, 0 });
+                nextClick += clickMs;
+            }
+        }
+        return out;
+    }
+}
+
+// --- Session recording and replay ---
+// A session is fully determined by the mode's RNG seed, the settings that
+// affect scoring, the starting camera and the mouse input applied before
+// each tick, so that is all a recording holds. File layout ("AIMR"):
+//   header: magic, version, mode, challenge, seed, tick length, sensitivity,
+//           fov, view size (varints), drill (v5: varint size + Scenario
+//           record; v4: tracking pattern and target count bytes), start
+//           yaw/pitch, live score, event count (varint)
+//   events: varint tick delta, kind byte, varint ns into the tick, payload
+// Whole-count motion deltas (what relative mouse mode reports) are zigzag
+// varints, anything else raw floats, so replayed input is bit-identical.
+// Multi-byte fields are little-endian.
+namespace Replay {
+    static const char* DIR = "replays";
+    static const Uint8 VERSION = 5;   // 3 added the view size, 4 the tracking drill, 5 the Scenario
+    enum Kind : Uint8 { MOTION_INT, MOTION_FLOAT, CLICK };
+
+    struct Event {
+        Uint32 tick;   // applied before this tick's update
+        Uint32 intoTickNS;
+        HeadlessSim::EventType type;
+        float xrel, yrel;
+    };
+    struct Recording {
+        Uint8  mode = MODE_GRIDSHOT;
+        bool   challenge = false;
+        Uint64 seed = 0, tickNS = 0;
+        float  sensitivity = 1.0f, fov = 90.0f;
+        int    viewW = DEFAULT_WINDOW_WIDTH, viewH = DEFAULT_WINDOW_HEIGHT;   // sets the vertical FOV
+        Scenario scenario = Scenario::builtin(MODE_GRIDSHOT);
+        Uint8  version = VERSION;
+        double camYaw = 0, camPitch = 0;
+        double score = 0;   // as scored live
+        std::vector<Event> events;
+    };
+
+    static void putVarint(std::vector<Uint8>& b, Uint64 v) {
+        while (v >= 0x80) { b.push_back(Uint8(v) | 0x80); v >>= 7; }
+        b.push_back(Uint8(v));
+    }
+    static bool getVarint(const Uint8*& p, const Uint8* end, Uint64& v) {
+        v = 0;
+        for (int shift = 0; p < end && shift < 64; shift += 7) {
+            Uint8 c = *p++;
+            v |= Uint64(c & 0x7f) << shift;
+            if (!(c & 0x80)) return true;
+        }
+        return false;
+    }
+    template<class T>
+    static void putRaw(std::vector<Uint8>& b, const T& v) {
+        const Uint8* p = reinterpret_cast<const Uint8*>(&v);
+        b.insert(b.end(), p, p + sizeof(T));
+    }
+    template<class T>
+    static bool getRaw(const Uint8*& p, const Uint8* end, T& v) {
+        if (size_t(end - p) < sizeof(T)) return false;
+        memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+    static Uint64 zigzag(Sint64 v) { return (Uint64(v) << 1) ^ Uint64(v >> 63); }
+    static Sint64 unzigzag(Uint64 v) { return Sint64(v >> 1) ^ -Sint64(v & 1); }
+    static bool isWhole(float f) { return fabsf(f) < 1e6f && float(int(f)) == f; }
+
+    static void encode(const Recording& r, std::vector<Uint8>& b) {
+        b.clear();
+        b.reserve(64 + r.events.size() * 4);
+        b.insert(b.end(), { 'A','I','M','R', VERSION, r.mode, Uint8(r.challenge) });
+        putRaw(b, r.seed);
+        putRaw(b, r.tickNS);
+        putRaw(b, r.sensitivity);
+        putRaw(b, r.fov);
+        putVarint(b, Uint64(r.viewW));
+        putVarint(b, Uint64(r.viewH));
+        putVarint(b, sizeof(Scenario));
+        putRaw(b, r.scenario);
+        putRaw(b, r.camYaw);
+        putRaw(b, r.camPitch);
+        putRaw(b, r.score);
+        putVarint(b, r.events.size());
+        Uint32 tick = 0;
+        for (const Event& e : r.events) {
+            putVarint(b, e.tick - tick);
+            tick = e.tick;
+            Uint8 kind = e.type == HeadlessSim::CLICK ? CLICK
+                : isWhole(e.xrel) && isWhole(e.yrel) ? MOTION_INT : MOTION_FLOAT;
+            b.push_back(kind);
+            putVarint(b, e.intoTickNS);
+            if (kind == MOTION_INT) {
+                putVarint(b, zigzag(int(e.xrel)));
+                putVarint(b, zigzag(int(e.yrel)));
+            }
+            else if (kind == MOTION_FLOAT) {
+                putRaw(b, e.xrel);
+                putRaw(b, e.yrel);
+            }
+        }
+    }
+
+    static bool decode(const std::vector<Uint8>& b, Recording& r) {
+        const Uint8* p = b.data();
+        const Uint8* end = p + b.size();
+        if (b.size() < 7 || memcmp(p, "AIMR", 4) != 0 || p[4] < 2 || p[4] > VERSION ||
+            p[5] >= MODE_COUNT)
+            return false;
+        Uint8 version = p[4];
+        r.mode = p[5];
+        r.challenge = p[6] != 0;
+        p += 7;
+        Uint64 count, vw = DEFAULT_WINDOW_WIDTH, vh = DEFAULT_WINDOW_HEIGHT;
+        if (!getRaw(p, end, r.seed) || !getRaw(p, end, r.tickNS) ||
+            !getRaw(p, end, r.sensitivity) || !getRaw(p, end, r.fov))
+            return false;
+        // version 2 files were recorded in the fixed 1280x720 window
+        if (version >= 3 && (!getVarint(p, end, vw) || !getVarint(p, end, vh) ||
+            vw == 0 || vh == 0 || vw > 65535 || vh > 65535))
+            return false;
+        r.viewW = int(vw);
+        r.viewH = int(vh);
+        r.version = version;
+        // before version 5 every session was a classic drill
+        r.scenario = Scenario::builtin(r.mode);
+        Uint64 size;
+        if (version >= 5) {
+            if (!getVarint(p, end, size) || size != sizeof(Scenario) || !getRaw(p, end, r.scenario) ||
+                r.scenario.mode != r.mode || Scenarios::validate(r.scenario))
+                return false;
+        }
+        else if (version == 4) {
+            if (end - p < 2 || p[0] >= MOTION_COUNT || p[1] < 1 || p[1] > MAX_TRACK_TARGETS)
+                return false;
+            if (r.mode == MODE_TRACKING) {
+                r.scenario.pattern = p[0];
+                r.scenario.targets = r.scenario.challengeTargets = p[1];
+            }
+            p += 2;
+        }
+        if (!getRaw(p, end, r.camYaw) || !getRaw(p, end, r.camPitch) ||
+            !getRaw(p, end, r.score) || !getVarint(p, end, count) ||
+            r.tickNS == 0 || count > b.size())
+            return false;
+        r.events.resize(size_t(count));
+        Uint64 tick = 0, dt, into, x, y;
+        for (Event& e : r.events) {
+            if (!getVarint(p, end, dt) || p >= end) return false;
+            e.tick = Uint32(tick += dt);
+            Uint8 kind = *p++;
+            if (!getVarint(p, end, into) || into > r.tickNS) return false;
+            e.intoTickNS = Uint32(into);
+            e.type = (kind == CLICK) ? HeadlessSim::CLICK : HeadlessSim::MOTION;
+            e.xrel = e.yrel = 0;
+            if (kind == MOTION_INT) {
+                if (!getVarint(p, end, x) || !getVarint(p, end, y)) return false;
+                e.xrel = float(unzigzag(x));
+                e.yrel = float(unzigzag(y));
+            }
+            else if (kind == MOTION_FLOAT) {
+                if (!getRaw(p, end, e.xrel) || !getRaw(p, end, e.yrel)) return false;
+            }
+            else if (kind != CLICK) return false;
+        }
+        return p == end;
+    }
+
+    static bool load(const char* path, Recording& r) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) return false;
+        std::vector<Uint8> b((std::istreambuf_iterator<char>(in)),
+            std::istreambuf_iterator<char>());
+        return decode(b, r);
+    }
+
+    // Collects the mouse input a live session applies; the main loop calls
+    // endTick() after every update so events carry their tick index.
+    class Recorder {
+    public:
+        void begin(Uint8 mode, const GameMode& m, Uint64 seed, Uint64 tickNS,
+            double camYaw, double camPitch) {
+            rec.mode = mode;
+            rec.challenge = m.isChallengeMode();
+            rec.seed = seed;
+            rec.tickNS = tickNS;
+            rec.sensitivity = m.ctx->sensitivity;
+            rec.fov = m.ctx->fov;
+            rec.viewW = m.ctx->viewW;
+            rec.viewH = m.ctx->viewH;
+            rec.scenario = m.scenario;
+            rec.camYaw = camYaw;
+            rec.camPitch = camPitch;
+            rec.events.clear();
+            rec.events.reserve(1 << 16);
+            tick = 0;
+            active = true;
+        }
+        void motion(Uint64 intoTickNS, float xrel, float yrel) {
+            if (active) rec.events.push_back({ tick, Uint32(intoTickNS), HeadlessSim::MOTION, xrel, yrel });
+        }
+        void click(Uint64 intoTickNS) {
+            if (active) rec.events.push_back({ tick, Uint32(intoTickNS), HeadlessSim::CLICK, 0, 0 });
+        }
+        void endTick() { ++tick; }
+        // Writes replays/<mode>-<date>-<time>.aimr for a finished session
+        // (unless !save; last() still has it).
+        void finish(double score, bool save = true) {
+            if (!active) return;
+            active = false;
+            rec.score = score;
+            if (!save) return;
+            std::vector<Uint8> buf;
+            encode(rec, buf);
+            char stamp[32], path[96];
+            time_t now = time(nullptr);
+            strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", localtime(&now));
+            sprintf(path, "%s/%s-%s.aimr", DIR, MODE_NAMES[rec.mode], stamp);
+            SDL_CreateDirectory(DIR);
+            persist.writeFile(path, std::move(buf));
+        }
+        const Recording& last() const { return rec; }
+    private:
+        Recording rec;
+        Uint32 tick = 0;
+        bool active = false;
+    };
+
+    // Re-simulates a recording tick by tick, exactly as the live loop did.
+    template<class Mode>
+    static double simulate(Mode& mode, const Recording& r) {
+        double camYaw = r.camYaw, camPitch = r.camPitch;
+        size_t next = 0;
+        mode.seed(r.seed);
+        if (mode.isChallengeMode() != r.challenge) mode.toggleChallengeMode();
+        mode.start();
+        for (Uint32 tick = 0; mode.isRunning(); ++tick) {
+            while (next < r.events.size() && r.events[next].tick <= tick) {
+                const Event& e = r.events[next++];
+                if (e.type == HeadlessSim::MOTION) {
+                    applyMouseMotion(camYaw, camPitch, e.xrel, e.yrel, mode.ctx->sensitivity);
+                    HeadlessSim::aim(mode, e.intoTickNS, camYaw, camPitch);
+                }
+                else HeadlessSim::click(mode, e.intoTickNS, camYaw, camPitch);
+            }
+            mode.update(r.tickNS, camYaw, camPitch);
+        }
+        return mode.getScore();
+    }
+
+    // One set of modes reused across replays (SwarmMode keeps its buffers),
+    // played in the recording's own context.
+    struct Player {
+        GridshotMode grid;
+        TrackingMode track;
+        SwarmMode    swarm;
+        SessionContext ctx;
+
+        Player() { grid.ctx = track.ctx = swarm.ctx = &ctx; }
+        Player(const Player&) = delete;
+
+        double play(const Recording& r) {
+            ctx.sensitivity = r.sensitivity;
+            ctx.fov = r.fov;
+            ctx.viewW = r.viewW;
+            ctx.viewH = r.viewH;
+            ctx.sync();
+            grid.scenario = track.scenario = swarm.scenario = r.scenario;
+            return r.mode == MODE_GRIDSHOT ? simulate(grid, r)
+                : r.mode == MODE_TRACKING ? simulate(track, r)
+                : simulate(swarm, r);
+        }
+    };
+
+    static void collect(const char* path, std::vector<std::string>& files, const char* pattern = "*.aimr") {
+        SDL_PathInfo info;
+        if (!SDL_GetPathInfo(path, &info)) {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "No such path: %s", path);
+            return;
+        }
+        if (info.type != SDL_PATHTYPE_DIRECTORY) { files.push_back(path); return; }
+        int count = 0;
+        char** names = SDL_GlobDirectory(path, pattern, 0, &count);
+        for (int i = 0; i < count; ++i)
+            files.push_back(std::string(path) + "/" + names[i]);
+        SDL_free(names);
+    }
+
+    // --replay: re-simulate every recording and compare against its live score.
+    static int run(int argc, char** argv) {
+        std::vector<std::string> files;
+        if (argc == 0) collect(DIR, files);
+        for (int i = 0; i < argc; ++i) collect(argv[i], files);
+        std::sort(files.begin(), files.end());
+        Player player;
+        Recording r;
+        int played = 0, mismatched = 0;
+        double simulatedSec = 0;
+        Uint64 t0 = SDL_GetTicksNS();
+        for (const std::string& f : files) {
+            if (!load(f.c_str(), r)) {
+                printf("%s: not a readable replay\n", f.c_str());
+                continue;
+            }
+            if (r.mode == MODE_TRACKING && r.version < 4) {
+                // scored by the closed-form single-target model MotionEngine replaced
+                printf("%s: tracking replay from before version 4, skipped\n", f.c_str());
+                continue;
+            }
+            double score = player.play(r);
+            bool same = score == r.score;
+            ++played;
+            mismatched += !same;
+            simulatedSec += (r.scenario.countdownMs + r.scenario.durationMs) / 1000.0;
+            if (!same || files.size() <= 50)
+                printf("%s: %s recorded %.3f replayed %.3f %s\n", f.c_str(),
+                    MODE_NAMES[r.mode], r.score, score, same ? "ok" : "MISMATCH");
+        }
+        double sec = (SDL_GetTicksNS() - t0) / 1e9;
+        if (sec <= 0) sec = 1e-9;
+        printf("%d replays, %d mismatched, %.3f s (%.0f replays/s, %.0fx real time)\n",
+            played, mismatched, sec, played / sec, simulatedSec / sec);
+        return mismatched ? 1 : 0;
+    }
+}
+
+// --- Shot telemetry files ---
+// telemetry/<mode>-<date>-<time>.aimt, one per finished session with
+// clicks, written by PersistWriter. Stored column by column so each column
+// packs into short varints ("AIMT"):
+//   header:  magic, version, mode, challenge, drill id (u64), start time
+//            (unix s), row count, rows dropped (varints)
+//   columns: time (varint deltas, us), yaw error, pitch error (zigzag
+//            varints, 1/1000 deg), flick (varint, 1/1000 deg), target age
+//            (varint, us), hit (bits, LSB first)
+namespace Telemetry {
+    static const char* DIR = "telemetry";
+    static const Uint8 VERSION = 1;
+    using Replay::putVarint; using Replay::getVarint;
+    using Replay::putRaw; using Replay::getRaw;
+    using Replay::zigzag; using Replay::unzigzag;
+
+    struct Header {
+        Uint8  mode = MODE_GRIDSHOT;
+        bool   challenge = false;
+        Uint64 drill = 0;       // Scenario::id, 0 for the classic modes
+        Uint64 startTime = 0;   // unix seconds
+    };
+
+    static Sint64 milli(float deg) { return Sint64(llround(double(deg) * 1000)); }
+
+    static void encode(const ShotLog& s, const Header& h, std::vector<Uint8>& b) {
+        b.clear();
+        b.reserve(32 + s.n * 12);
+        b.insert(b.end(), { 'A','I','M','T', VERSION, h.mode, Uint8(h.challenge) });
+        putRaw(b, h.drill);
+        putVarint(b, h.startTime);
+        putVarint(b, s.n);
+        putVarint(b, s.dropped);
+        Uint32 prev = 0;
+        for (size_t i = 0; i < s.n; ++i) { putVarint(b, s.timeUs[i] - prev); prev = s.timeUs[i]; }
+        for (size_t i = 0; i < s.n; ++i) putVarint(b, zigzag(milli(s.yawErr[i])));
+        for (size_t i = 0; i < s.n; ++i) putVarint(b, zigzag(milli(s.pitchErr[i])));
+        for (size_t i = 0; i < s.n; ++i) putVarint(b, Uint64(milli(s.flick[i])));
+        for (size_t i = 0; i < s.n; ++i) putVarint(b, s.ageUs[i]);
+        for (size_t i = 0; i < s.n; i += 8) {
+            Uint8 bits = 0;
+            for (size_t k = i; k < s.n && k < i + 8; ++k) bits |= Uint8(s.hit[k] << (k - i));
+            b.push_back(bits);
+        }
+    }
+
+    static bool decode(const std::vector<Uint8>& b, Header& h, ShotLog& s) {
+        const Uint8* p = b.data();
+        const Uint8* end = p + b.size();
+        if (b.size() < 7 || memcmp(p, "AIMT", 4) != 0 || p[4] != VERSION || p[5] >= MODE_COUNT)
+            return false;
+        h.mode = p[5];
+        h.challenge = p[6] != 0;
+        p += 7;
+        Uint64 count, dropped, v;
+        if (!getRaw(p, end, h.drill) || !getVarint(p, end, h.startTime) ||
+            !getVarint(p, end, count) || !getVarint(p, end, dropped) || count > b.size())
+            return false;
+        size_t n = size_t(count);
+        s.timeUs.resize(n); s.yawErr.resize(n); s.pitchErr.resize(n);
+        s.flick.resize(n); s.ageUs.resize(n); s.hit.resize(n);
+        s.n = n;
+        s.dropped = Uint32(dropped);
+        Uint64 t = 0;
+        for (size_t i = 0; i < n; ++i) { if (!getVarint(p, end, v)) return false; s.timeUs[i] = Uint32(t += v); }
+        for (size_t i = 0; i < n; ++i) { if (!getVarint(p, end, v)) return false; s.yawErr[i] = float(unzigzag(v) / 1000.0); }
+        for (size_t i = 0; i < n; ++i) { if (!getVarint(p, end, v)) return false; s.pitchErr[i] = float(unzigzag(v) / 1000.0); }
+        for (size_t i = 0; i < n; ++i) { if (!getVarint(p, end, v)) return false; s.flick[i] = float(v / 1000.0); }
+        for (size_t i = 0; i < n; ++i) { if (!getVarint(p, end, v)) return false; s.ageUs[i] = Uint32(v); }
+        if (size_t(end - p) != (n + 7) / 8) return false;
+        for (size_t i = 0; i < n; ++i) s.hit[i] = (p[i / 8] >> (i % 8)) & 1;
+        return true;
+    }
+
+    // Queues telemetry/<mode>-<date>-<time>.aimt for a finished session.
+    static void save(const ShotLog& s, Uint8 mode, const GameMode& m) {
+        if (s.n == 0) return;
+        Header h;
+        h.mode = mode;
+        h.challenge = m.isChallengeMode();
+        h.drill = m.scenario.id;
+        time_t now = time(nullptr);
+        h.startTime = Uint64(now);
+        std::vector<Uint8> buf;
+        encode(s, h, buf);
+        if (s.dropped)
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Shot log full, %u clicks not recorded", s.dropped);
+        char stamp[32], path[96];
+        strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", localtime(&now));
+        sprintf(path, "%s/%s-%s.aimt", DIR, MODE_NAMES[mode], stamp);
+        SDL_CreateDirectory(DIR);
+        persist.writeFile(path, std::move(buf));
+    }
+
+    // --shots: every shot of the given files/folders (default "telemetry")
+    // as CSV on stdout.
+    static int run(int argc, char** argv) {
+        std::vector<std::string> files;
+        if (argc == 0) Replay::collect(DIR, files, "*.aimt");
+        for (int i = 0; i < argc; ++i) Replay::collect(argv[i], files, "*.aimt");
+        std::sort(files.begin(), files.end());
+        printf("file,mode,challenge,drill,shot,time_ms,yaw_err,pitch_err,flick,age_ms,hit\n");
+        Header h;
+        ShotLog s;
+        std::string data;
+        int bad = 0;
+        for (const std::string& f : files) {
+            if (!readFile(f.c_str(), data) ||
+                !decode(std::vector<Uint8>(data.begin(), data.end()), h, s)) {
+                fprintf(stderr, "%s: not a readable telemetry file\n", f.c_str());
+                ++bad;
+                continue;
+            }
+            for (size_t i = 0; i < s.n; ++i)
+                printf("%s,%s,%d,%016llx,%zu,%.3f,%.3f,%.3f,%.3f,%.3f,%d\n", f.c_str(),
+                    MODE_NAMES[h.mode], int(h.challenge), (unsigned long long)h.drill, i,
+                    s.timeUs[i] / 1000.0, s.yawErr[i], s.pitchErr[i], s.flick[i],
+                    s.ageUs[i] / 1000.0, int(s.hit[i]));
+        }
+        return bad ? 1 : 0;
+    }
+}
+
+// --- Trace latency report ---
+namespace Trace {
+    // --trace-latency [PATH]: the input-to-present latency of every input a
+    // trace (default TRACE_FILE) tagged, as CSV on stdout and as a
+    // distribution on stderr. An input's frame is the first presented one
+    // that drew its effect; latency runs from the input's SDL timestamp to
+    // the end of that frame's present.
+    static int runLatency(int argc, char** argv) {
+        const char* path = argc > 0 ? argv[0] : TRACE_FILE;
+        std::string txt;
+        if (!readFile(path, txt)) {
+            fprintf(stderr, "%s: cannot read\n", path);
+            return 1;
+        }
+        std::unordered_map<Uint64, double> presentEnd;   // frame -> us
+        std::vector<std::pair<Uint64, double>> inputs;   // frame, us
+        JSONStorage::Parser p(txt);
+        bool ok = p.object([&](std::string_view key) {
+            if (key != "traceEvents") return p.skip(0);
+            return p.array([&] {
+                std::string_view name;
+                double ts = 0, dur = 0, frame = 0;
+                if (!p.object([&](std::string_view k) {
+                    if (k == "name") return p.string(name);
+                    if (k == "ts") return p.number(ts);
+                    if (k == "dur") return p.number(dur);
+                    if (k == "args") return p.object([&](std::string_view a) {
+                        return a == "frame" ? p.number(frame) : p.skip(0);
+                        });
+                    return p.skip(0);
+                    }))
+                    return false;
+                if (frame < 1) return true;
+                if (name == "present") presentEnd[Uint64(frame)] = ts + dur;
+                else if (name == "input") inputs.push_back({ Uint64(frame), ts });
+                return true;
+                });
+            });
+        if (!ok) {
+            fprintf(stderr, "%s: byte %zu: %s\n", path, p.errorPos, p.error);
+            return 1;
+        }
+        printf("frame,input_ms,present_ms,latency_ms\n");
+        std::vector<double> latency;
+        size_t untagged = 0;
+        for (const auto& in : inputs) {
+            auto f = presentEnd.find(in.first);
+            if (f == presentEnd.end()) { ++untagged; continue; }   // its present fell out of the ring
+            latency.push_back((f->second - in.second) / 1e3);
+            printf("%llu,%.3f,%.3f,%.3f\n", (unsigned long long)in.first,
+                in.second / 1e3, f->second / 1e3, latency.back());
+        }
+        ScoreStats st(latency);
+        fprintf(stderr, "%zu inputs over %zu frames: latency mean %.2f ms, sd %.2f, p10 %.2f, p50 %.2f,"
+            " p90 %.2f, max %.2f (%zu without their frame)\n", st.n, presentEnd.size(), st.mean, st.sd,
+            st.p10, st.p50, st.p90, latency.empty() ? 0.0 : latency.back(), untagged);
+        return 0;
+    }
+}
+
+// --- Work-stealing pool ---
+// Runs job(worker, i) for every i in [0, count) on up to N threads, the
+// caller being worker 0. Each worker starts with an equal slice of the
+// indices and takes from its front; one that runs dry moves the back half
+// of the largest remaining slice into its own. Taking an index is one
+// uncontended spinlock, so jobs can be as small as a single session.
+class WorkPool {
 public:
-    float sensVal, fovVal;
-    int gapVal, lenVal, rVal, gVal, bVal;
-    bool challengeVal;
-    Rect sensBar, fovBar, gapBar, lenBar, rBar, gBar, bBar;
-    Rect sensKnob, fovKnob, gapKnob, lenKnob, rKnob, gKnob, bKnob;
-    Rect applyBtn, resetBtn, challengeBtn;
-    int dragging, hoverBtn;
-    bool hoverChallenge;
+    Uint64 steals = 0;
 
-    SettingsMenu() {
-        sensVal = config.sensitivity;
-        fovVal = config.fov;
-        gapVal = config.cross_gap;
-        lenVal = config.cross_len;
-        rVal = config.cross_r;
-        gVal = config.cross_g;
-        bVal = config.cross_b;
-        challengeVal = config.challengeMode;
+    template<class Job>
+    void run(int threads, size_t count, Job&& job) {
+        threads = std::max(1, int(std::min<size_t>(size_t(std::max(threads, 1)), std::max<size_t>(count, 1))));
+        slices = std::vector<Slice>(threads);
+        for (int w = 0; w < threads; ++w) {
+            slices[w].begin = count * w / threads;
+            slices[w].end = count * (w + 1) / threads;
+        }
+        using J = std::remove_reference_t<Job>;
+        fn = &job;
+        call = [](void* f, int w, size_t i) { (*static_cast<J*>(f))(w, i); };
+        stolen = 0;
+        std::vector<Start> starts(threads);
+        std::vector<SDL_Thread*> th(threads, nullptr);
+        // a worker that fails to start just leaves its slice to be stolen
+        for (int w = 1; w < threads; ++w) {
+            starts[w] = { this, w };
+            th[w] = SDL_CreateThread(trampoline, "sweep", &starts[w]);
+        }
+        work(0);
+        for (int w = 1; w < threads; ++w)
+            if (th[w]) SDL_WaitThread(th[w], nullptr);
+        steals = stolen;
+    }
 
-        sensBar = { WINDOW_WIDTH / 2 - 150,WINDOW_HEIGHT / 2 - 80,300,6 };
-        fovBar = { WINDOW_WIDTH / 2 - 150,WINDOW_HEIGHT / 2 - 40,300,6 };
-        gapBar = { WINDOW_WIDTH / 2 - 150,WINDOW_HEIGHT / 2,   300,6 };
-        lenBar = { WINDOW_WIDTH / 2 - 150,WINDOW_HEIGHT / 2 + 40,300,6 };
-        rBar = { WINDOW_WIDTH / 2 - 150,WINDOW_HEIGHT / 2 + 80,300,6 };
-        gBar = { WINDOW_WIDTH / 2 - 150,WINDOW_HEIGHT / 2 + 120,300,6 };
-        bBar = { WINDOW_WIDTH / 2 - 150,WINDOW_HEIGHT / 2 + 160,300,6 };
+private:
+    struct alignas(64) Slice {
+        SDL_SpinLock lock = 0;
+        std::atomic<size_t> begin{ 0 }, end{ 0 };   // written under lock, peeked without
+    };
+    struct Start { WorkPool* pool; int w; };
+    std::vector<Slice> slices;
+    std::atomic<Uint64> stolen{ 0 };
+    void* fn = nullptr;
+    void (*call)(void*, int, size_t) = nullptr;
 
-        sensKnob.w = sensKnob.h =
-            fovKnob.w = fovKnob.h =
-            gapKnob.w = gapKnob.h =
-            lenKnob.w = lenKnob.h =
-            rKnob.w = rKnob.h =
-            gKnob.w = gKnob.h =
-            bKnob.w = bKnob.h = 12;
+    static int SDLCALL trampoline(void* p) {
+        Start* s = static_cast<Start*>(p);
+        s->pool->work(s->w);
+        return 0;
+    }
 
-        applyBtn = { WINDOW_WIDTH / 2 - 100,WINDOW_HEIGHT / 2 + 200,80,30 };
-        resetBtn = { WINDOW_WIDTH / 2 + 20, WINDOW_HEIGHT / 2 + 200,80,30 };
-        challengeBtn = { WINDOW_WIDTH / 2 - 100,WINDOW_HEIGHT / 2 + 250,200,30 };
+    bool take(int w, size_t& i) {
+        Slice& s = slices[w];
+        SDL_LockSpinlock(&s.lock);
+        size_t b = s.begin.load(std::memory_order_relaxed);
+        bool got = b < s.end.load(std::memory_order_relaxed);
+        if (got) { i = b; s.begin.store(b + 1, std::memory_order_relaxed); }
+        SDL_UnlockSpinlock(&s.lock);
+        return got;
+    }
 
-        dragging = 0;hoverBtn = -1;hoverChallenge = false;
-        updateKnobs();
+    bool steal(int w) {
+        int n = int(slices.size());
+        for (;;) {
+            int victim = -1;
+            size_t most = 0;
+            for (int k = 1; k < n; ++k) {
+                const Slice& s = slices[(w + k) % n];
+                size_t b = s.begin.load(std::memory_order_relaxed), e = s.end.load(std::memory_order_relaxed);
+                if (e > b && e - b > most) { most = e - b; victim = (w + k) % n; }
+            }
+            if (victim < 0) return false;
+            Slice& v = slices[victim];
+            SDL_LockSpinlock(&v.lock);
+            size_t b = v.begin.load(std::memory_order_relaxed), e = v.end.load(std::memory_order_relaxed);
+            size_t half = e > b ? (e - b + 1) / 2 : 0;
+            v.end.store(e - half, std::memory_order_relaxed);
+            SDL_UnlockSpinlock(&v.lock);
+            if (!half) continue;   // emptied meanwhile, look again
+            Slice& mine = slices[w];
+            SDL_LockSpinlock(&mine.lock);
+            mine.begin.store(e - half, std::memory_order_relaxed);
+            mine.end.store(e, std::memory_order_relaxed);
+            SDL_UnlockSpinlock(&mine.lock);
+            ++stolen;
+            return true;
+        }
     }
 
-    void updateKnobs() {
-        auto place = [&](const Rect& bar, Rect& knob, float val, float mn, float mx) {
-            float n = (val - mn) / (mx - mn);
-            n = CLAMP(n, 0.f, 1.f);
-            knob.x = bar.x + int(n * bar.w) - knob.w / 2;
-            knob.y = bar.y - knob.h / 2 + bar.h / 2;
+    void work(int w) {
+        size_t i;
+        do {
+            while (take(w, i)) call(fn, w, i);
+        } while (steal(w));
+    }
+};
+
+// --- Parameter sweep ---
+// --sweep: headless sessions over a grid of drill parameters x input
+// profiles on every core, one CSV row of score statistics per cell.
+//   --mode NAME | --drill FILE   base drill (default: classic gridshot)
+//   --set KEY=V1,V2,...          an axis; KEY=LO:HI:STEP for a range. Keys
+//                                are the drill file fields plus pattern
+//                                (motion names) and challengeMode (0/1)
+//   --profiles A,B,...           novice/average/skilled/pro (SimPlayer) and
+//                                random (scripted input); default all skills
+//   --sessions N                 per cell and profile (default 32)
+//   --threads N                  default: logical cores
+//   --sensitivity S, --fov F, --view WxH   the session context
+// Session s of every cell uses the same seeds, so cells differ by their
+// parameters rather than by luck.
+namespace Sweep {
+    enum { AXIS_PATTERN = -1, AXIS_CHALLENGE = -2 };
+    static const int PROFILE_RANDOM = SimPlayer::SKILL_COUNT;
+
+    struct Axis {
+        std::string key;
+        int field;   // Scenarios::FIELDS index or AXIS_*
+        std::vector<double> values;
+    };
+    struct Cell {
+        Scenario scenario;
+        bool challenge;
+        std::vector<int> at;   // value index per axis
+    };
+
+    // one per thread: its own context, modes and player
+    struct Worker {
+        SessionContext ctx;
+        GridshotMode grid;
+        TrackingMode track;
+        SwarmMode swarm;
+        SimPlayer player;
+    };
+
+    template<class Mode>
+    static double play(Mode& mode, Worker& w, const Cell& c, int profile, Uint64 seed) {
+        mode.scenario = c.scenario;
+        if (mode.isChallengeMode() != c.challenge) mode.toggleChallengeMode();
+        if (profile < PROFILE_RANDOM)
+            return HeadlessSim::runPlayer(mode, w.player, SimPlayer::SKILLS[profile], seed);
+        mode.seed(seed);
+        return HeadlessSim::runSession(mode, HeadlessSim::makeScript(Uint32(seed), 125, 300,
+            Uint32(c.scenario.countdownMs + c.scenario.durationMs)));
+    }
+
+    static bool parseAxis(const char* spec, Axis& a) {
+        const char* eq = strchr(spec, '=');
+        if (!eq) return false;
+        a.key.assign(spec, eq - spec);
+        a.values.clear();
+        if (a.key == "pattern") a.field = AXIS_PATTERN;
+        else if (a.key == "challengeMode") a.field = AXIS_CHALLENGE;
+        else if ((a.field = Scenarios::fieldIndex(a.key)) < 0) return false;
+        std::string list(eq + 1);
+        double lo, hi, step;
+        if (a.field != AXIS_PATTERN && sscanf(list.c_str(), "%lf:%lf:%lf", &lo, &hi, &step) == 3) {
+            if (step <= 0 || hi < lo || (hi - lo) / step > 10000) return false;
+            for (int k = 0; lo + k * step <= hi + step * 1e-9; ++k) a.values.push_back(lo + k * step);
+            return true;
+        }
+        std::stringstream in(list);
+        std::string item;
+        while (std::getline(in, item, ',')) {
+            if (a.field == AXIS_PATTERN) {
+                int p = 0;
+                while (p < MOTION_COUNT && item != MOTION_NAMES[p]) ++p;
+                if (p == MOTION_COUNT) return false;
+                a.values.push_back(p);
+            }
+            else {
+                char* end;
+                double v = strtod(item.c_str(), &end);
+                if (end == item.c_str() || *end) return false;
+                a.values.push_back(v);
+            }
+        }
+        return !a.values.empty();
+    }
+
+    static int run(int argc, char** argv) {
+        Scenario base = Scenario::builtin(MODE_GRIDSHOT);
+        std::vector<Axis> axes;
+        std::vector<int> profiles;
+        int sessions = 32, threads = SDL_GetNumLogicalCPUCores();
+        SessionContext ctx;
+        ctx.sensitivity = config.sensitivity >= 0.001f ? config.sensitivity : 0.05f;
+        ctx.fov = config.fov >= 60.0f ? config.fov : 90.0f;
+        for (int i = 0; i < argc; ++i) {
+            const char* arg = argv[i];
+            const char* val = i + 1 < argc ? argv[i + 1] : nullptr;
+            bool ok = val != nullptr;
+            if (ok && strcmp(arg, "--mode") == 0) {
+                int m = 0;
+                while (m < MODE_COUNT && strcmp(val, MODE_NAMES[m]) != 0) ++m;
+                if ((ok = m < MODE_COUNT)) base = Scenario::builtin(m);
+            }
+            else if (ok && strcmp(arg, "--drill") == 0) {
+                std::string text;
+                char why[160] = "unreadable";
+                ok = readFile(val, text) && Scenarios::compile(text, val, base, why, sizeof(why));
+                if (!ok) fprintf(stderr, "%s: %s\n", val, why);
+            }
+            else if (ok && strcmp(arg, "--set") == 0) {
+                axes.emplace_back();
+                ok = parseAxis(val, axes.back());
+            }
+            else if (ok && strcmp(arg, "--profiles") == 0) {
+                std::stringstream in(val);
+                std::string item;
+                while (ok && std::getline(in, item, ',')) {
+                    const SimPlayer::Skill* s = SimPlayer::findSkill(item.c_str());
+                    ok = s || item == "random";
+                    profiles.push_back(s ? int(s - SimPlayer::SKILLS) : PROFILE_RANDOM);
+                }
+            }
+            else if (ok && strcmp(arg, "--sessions") == 0) ok = (sessions = atoi(val)) > 0;
+            else if (ok && strcmp(arg, "--threads") == 0) ok = (threads = atoi(val)) > 0;
+            else if (ok && strcmp(arg, "--sensitivity") == 0) ok = (ctx.sensitivity = float(atof(val))) > 0;
+            else if (ok && strcmp(arg, "--fov") == 0) {
+                ctx.fov = float(atof(val));
+                ok = ctx.fov >= 10 && ctx.fov <= 179;   // 179: SCHEMA's fov bound
+            }
+            else if (ok && strcmp(arg, "--view") == 0)
+                ok = sscanf(val, "%dx%d", &ctx.viewW, &ctx.viewH) == 2 && ctx.viewW > 0 && ctx.viewH > 0;
+            else ok = false;
+            if (!ok) {
+                fprintf(stderr, "bad sweep argument: %s %s\n", arg, val ? val : "");
+                return 2;
+            }
+            ++i;
+        }
+        if (profiles.empty())
+            for (int p = 0; p < SimPlayer::SKILL_COUNT; ++p) profiles.push_back(p);
+        ctx.sync();
+
+        // the grid, row-major over the axes; invalid combinations are reported and left out
+        std::vector<Cell> cells;
+        std::vector<int> at(axes.size(), 0);
+        bool sweepsMaxSize = false;
+        for (const Axis& a : axes) sweepsMaxSize |= a.key == "maxSize";
+        for (;;) {
+            Cell c{ base, false, at };
+            for (size_t a = 0; a < axes.size(); ++a) {
+                double v = axes[a].values[at[a]];
+                if (axes[a].field == AXIS_PATTERN) c.scenario.pattern = int(v);
+                else if (axes[a].field == AXIS_CHALLENGE) c.challenge = v != 0;
+                else {
+                    const Scenarios::Field& fd = Scenarios::FIELDS[axes[a].field];
+                    if (fd.i) c.scenario.*fd.i = int(lround(v));
+                    else c.scenario.*fd.f = v;
+                }
+            }
+            // as in drill files: maxSize follows size unless given
+            if (!sweepsMaxSize) c.scenario.maxSize = std::max(c.scenario.maxSize, c.scenario.size);
+            std::string_view field;
+            if (const char* why = Scenarios::validate(c.scenario, &field))
+                fprintf(stderr, "skipped a cell: %.*s %s\n", int(field.size()), field.data(), why);
+            else cells.push_back(c);
+            size_t a = 0;
+            while (a < axes.size() && ++at[a] == int(axes[a].values.size())) at[a++] = 0;
+            if (a == axes.size()) break;
+        }
+
+        size_t runs = cells.size() * profiles.size();
+        size_t total = runs * sessions;
+        std::vector<double> scores(total);
+        std::vector<Worker> workers(size_t(std::max(threads, 1)));
+        for (Worker& w : workers) {
+            w.ctx = ctx;
+            w.grid.ctx = w.track.ctx = w.swarm.ctx = &w.ctx;
+        }
+        WorkPool pool;
+        Uint64 t0 = SDL_GetTicksNS();
+        pool.run(threads, total, [&](int wi, size_t i) {
+            Worker& w = workers[wi];
+            const Cell& c = cells[i / sessions / profiles.size()];
+            int profile = profiles[i / sessions % profiles.size()];
+            Uint64 seed = 0x9E3779B97F4A7C15ull * Uint64(i % sessions + 1);
+            scores[i] = c.scenario.mode == MODE_GRIDSHOT ? play(w.grid, w, c, profile, seed)
+                : c.scenario.mode == MODE_TRACKING ? play(w.track, w, c, profile, seed)
+                : play(w.swarm, w, c, profile, seed);
+            });
+        double sec = (SDL_GetTicksNS() - t0) / 1e9;
+
+        for (const Axis& a : axes) printf("%s,", a.key.c_str());
+        printf("profile,sessions,mean,sd,p10,p50,p90\n");
+        std::vector<double> cell;
+        double simulatedSec = 0;
+        for (size_t r = 0; r < runs; ++r) {
+            const Cell& c = cells[r / profiles.size()];
+            int profile = profiles[r % profiles.size()];
+            for (size_t a = 0; a < axes.size(); ++a) {
+                double v = axes[a].values[c.at[a]];
+                if (axes[a].field == AXIS_PATTERN) printf("%s,", MOTION_NAMES[int(v)]);
+                else printf("%g,", v);
+            }
+            cell.assign(scores.begin() + r * sessions, scores.begin() + (r + 1) * sessions);
+            ScoreStats st(cell);
+            printf("%s,%zu,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+                profile < PROFILE_RANDOM ? SimPlayer::SKILLS[profile].name : "random",
+                st.n, st.mean, st.sd, st.p10, st.p50, st.p90);
+            simulatedSec += sessions * (c.scenario.countdownMs + c.scenario.durationMs) / 1000.0;
+        }
+        if (sec <= 0) sec = 1e-9;
+        fprintf(stderr, "%zu cells x %zu profiles x %d sessions on %d threads: %.2f s, "
+            "%.0f sessions/s, %.0fx real time, %llu steals\n",
+            cells.size(), profiles.size(), sessions, int(std::min<size_t>(workers.size(), std::max<size_t>(total, 1))),
+            sec, total / sec, simulatedSec / sec, (unsigned long long)pool.steals);
+        return 0;
+    }
+}
+
+// --- Benchmarks (see command line options at the top) ---
+namespace Bench {
+    static volatile double sink_;   // keeps timed loops from being optimized out
+
+    template<class Mode>
+    static void headlessThroughput(const char* name, int sessions) {
+        Mode mode;
+        std::vector<HeadlessSim::Event> script = HeadlessSim::makeScript(12345u, 125, 300);
+        double checksum = 0;
+        Uint64 t0 = SDL_GetTicksNS();
+        for (int i = 0; i < sessions; ++i)
+            checksum += HeadlessSim::runSession(mode, script);
+        double sec = (SDL_GetTicksNS() - t0) / 1e9;
+        printf("%s: %d sessions in %.3f s (%.0f sessions/s, mean score %.2f)\n",
+            name, sessions, sec, sessions / (sec > 0 ? sec : 1e-9), checksum / sessions);
+    }
+
+    // old per-frame path: re-derive vFOV and divide by tan(FOV/2) per target
+    static int runProjection(int n) {
+        if (n <= 0) n = 10000;
+        config.fov = 103.0f;
+        syncLiveContext();
+        std::vector<float> dy(n), dp(n), sx(n), sy(n);
+        std::vector<int> vis(n);
+        Uint32 seed = 7;
+        for (int i = 0;i < n;++i) {
+            seed = seed * 1664525u + 1013904223u;
+            dy[i] = (seed >> 8) / float(1 << 24) * 180.0f - 90.0f;
+            seed = seed * 1664525u + 1013904223u;
+            dp[i] = (seed >> 8) / float(1 << 24) * 120.0f - 60.0f;
+        }
+        const int reps = 200;
+        double sink = 0;
+        Uint64 t0 = SDL_GetTicksNS();
+        for (int r = 0;r < reps;++r) {
+            for (int i = 0;i < n;++i) {
+                double hF = config.fov, asp = double(view.w) / view.h;
+                double vF = (180.0 / M_PI) * 2 * atan(tan(hF * M_PI / 180.0 / 2) * (1.0 / asp));
+                if (fabs(dy[i]) > hF / 2 + 5 || fabs(dp[i]) > vF / 2 + 5) continue;
+                double xN = tan(dy[i] * M_PI / 180.0) / tan(hF * M_PI / 180.0 / 2);
+                double yN = tan(dp[i] * M_PI / 180.0) / tan(vF * M_PI / 180.0 / 2);
+                sink += xN + yN;
+            }
+        }
+        Uint64 t1 = SDL_GetTicksNS();
+        for (int r = 0;r < reps;++r) {
+            for (int i = 0;i < n;++i) {
+                int x, y;
+                if (liveContext.proj.project(dy[i], dp[i], 5.0, x, y)) sink += x + y;
+            }
+        }
+        Uint64 t2 = SDL_GetTicksNS();
+        int visible = 0;
+        for (int r = 0;r < reps;++r)
+            visible = liveContext.proj.projectBatch(dy.data(), dp.data(), n, 5.0f,
+                sx.data(), sy.data(), vis.data());
+        Uint64 t3 = SDL_GetTicksNS();
+        double maxErr = 0;
+        for (int k = 0;k < visible;++k) {
+            int i = vis[k];
+            double ex = liveContext.proj.cx + tan(dy[i] * M_PI / 180.0) * liveContext.proj.kx;
+            double ey = liveContext.proj.cy - tan(dp[i] * M_PI / 180.0) * liveContext.proj.ky;
+            maxErr = std::max(maxErr, std::max(fabs(sx[i] - ex), fabs(sy[i] - ey)));
+        }
+        double per = 1.0 / (double(n) * reps);
+        printf("projection naive:  %.2f ns/target\n", (t1 - t0) * per);
+        printf("projection cached: %.2f ns/target\n", (t2 - t1) * per);
+        printf("projection batch:  %.2f ns/target (%d/%d visible, max err %.4f px)\n",
+            (t3 - t2) * per, visible, n, maxErr);
+        sink_ = sink;
+        return 0;
+    }
+
+    // Click and cull cost of SwarmMode as the target count grows. Density
+    // is held constant (the field grows with the count), so per-click cost
+    // and cull cost per drawn target should stay flat.
+    static int runSwarm(int clicks) {
+        if (clicks <= 0) clicks = 100000;
+        config.fov = 103.0f;
+        syncLiveContext();
+        const double density = 10000.0 / (360.0 * 90.0);   // targets per deg^2
+        const int counts[] = { 9, 100, 1000, 10000 };
+        for (int n : counts) {
+            SwarmMode m;
+            Scenario& sc = m.scenario;
+            sc.targets = n;
+            double area = n / density;   // (2*fieldYaw) x (2*fieldPitch), 2:1
+            sc.fieldPitch = std::min(45.0, sqrt(area / 8.0));
+            sc.fieldYaw = std::min(180.0, area / (4.0 * sc.fieldPitch));
+            m.start();
+            std::vector<double> cy(clicks), cp(clicks);
+            for (int i = 0;i < clicks;++i) {
+                cy[i] = fmod(360.0 + (rand() / double(RAND_MAX) * 2 - 1) * sc.fieldYaw, 360.0);
+                cp[i] = (rand() / double(RAND_MAX) * 2 - 1) * sc.fieldPitch;
+            }
+            Uint64 t0 = SDL_GetTicksNS();
+            int hits = 0;
+            for (int i = 0;i < clicks;++i) hits += m.handleClick(cy[i], cp[i]);
+            Uint64 t1 = SDL_GetTicksNS();
+            const int frames = 2000;
+            long long drawn = 0;
+            Snapshot s;
+            s.viewYaw = float(liveContext.proj.hFov / 2);
+            s.viewPitch = float(liveContext.proj.vFov / 2);
+            for (int i = 0;i < frames;++i) {
+                s.prevYaw = s.camYaw = cy[i];
+                s.prevPitch = s.camPitch = cp[i];
+                m.snapshot(s);
+                drawn += m.gatherVisible(s, cy[i], cp[i]);
+            }
+            Uint64 t2 = SDL_GetTicksNS();
+            printf("swarm n=%5d: click %.0f ns (%d hits), cull+project %.1f us/frame"
+                " (%.0f drawn, %.1f ns/drawn)\n",
+                n, double(t1 - t0) / clicks, hits, (t2 - t1) / 1e3 / frames,
+                double(drawn) / frames, double(t2 - t1) / std::max(1ll, drawn));
+        }
+        return 0;
+    }
+
+    // One session where the aim moves on and off a stationary target every
+    // 50-400 us, several times inside each motion step. The exact score is
+    // the summed on-target time; returns how far the session's score is off.
+    static double subStepError(TrackingMode& mode, Uint32 seed, Uint32 rate) {
+        std::vector<TargetInfo> tg;
+        mode.seed(seed);
+        mode.start();
+        mode.listTargets(0, 0, tg);
+        double onYaw = tg[0].yaw, offYaw = onYaw + 3 * mode.scenario.size, pitch = tg[0].pitch;
+        Uint64 tickNS = SDL_NS_PER_SECOND / rate, duration = SDL_MS_TO_NS(mode.scenario.durationMs);
+        Uint64 now = 0, next = 0, last = 0, onNS = 0;
+        bool on = false;
+        mode.aim(0, offYaw, pitch);
+        while (mode.isRunning()) {
+            for (; next <= now + tickNS && next < duration; ) {
+                if (on) onNS += next - last;
+                last = next;
+                on = !on;
+                mode.aim(next - now, on ? onYaw : offYaw, pitch);
+                seed = seed * 1664525u + 1013904223u;
+                next += 50000 + (seed >> 8) % 350001;
+            }
+            mode.update(tickNS, on ? onYaw : offYaw, pitch);
+            now += tickNS;
+        }
+        if (on) onNS += duration - last;
+        return fabs(mode.getScore() - onNS / 1e9);
+    }
+
+    // TrackingMode scores between input timestamps, so the same input must
+    // score identically at any tick rate. Sessions cycle through the motion
+    // patterns and 1-4 targets; wide targets keep the aim crossing their
+    // edges all session.
+    static int runTracking(int sessions) {
+        if (sessions <= 0) sessions = 200;
+        if (config.sensitivity < 0.001f) config.sensitivity = 1.0f;
+        if (config.fov < 60.0f)          config.fov = 90.0f;
+        syncLiveContext();
+        const Uint32 rates[] = { 30, 144, 1000 };
+        TrackingMode mode;
+        Scenario& sc = mode.scenario;
+        sc.size = 20.0;
+        double total[3] = {}, sec[3] = {};
+        int mismatched = 0;
+        for (int i = 0; i < sessions; ++i) {
+            // jitter the 2 ms motion cadence so events land anywhere in a tick
+            std::vector<HeadlessSim::Event> script =
+                HeadlessSim::makeScript(1000u + i, 500, COUNTDOWN_DURATION_MS + GAME_DURATION_MS + 1);
+            Uint32 seed = i;
+            for (HeadlessSim::Event& e : script) {
+                seed = seed * 1664525u + 1013904223u;
+                e.timeNS += (seed >> 8) % 1000000;
+            }
+            sc.pattern = i % MOTION_COUNT;
+            sc.targets = 1 + i / MOTION_COUNT % 4;
+            double score[3];
+            for (int r = 0; r < 3; ++r) {
+                mode.seed(i);
+                Uint64 t0 = SDL_GetTicksNS();
+                score[r] = HeadlessSim::runSession(mode, script, SDL_NS_PER_SECOND / rates[r]);
+                sec[r] += (SDL_GetTicksNS() - t0) / 1e9;
+                total[r] += score[r];
+            }
+            if (score[0] != score[2] || score[1] != score[2]) {
+                ++mismatched;
+                printf("session %d (%s x%d): %.9f / %.9f / %.9f\n", i,
+                    MOTION_NAMES[sc.pattern], sc.targets, score[0], score[1], score[2]);
+            }
+        }
+        for (int r = 0; r < 3; ++r)
+            printf("tracking @%4u ticks/s: mean score %.6f, %.1f us/session\n",
+                rates[r], total[r] / sessions, sec[r] * 1e6 / sessions);
+        printf("%d/%d sessions scored identically at every tick rate\n",
+            sessions - mismatched, sessions);
+
+        // sub-step accuracy against a stationary target
+        sc.pattern = MOTION_BOUNCE;
+        sc.targets = 1;
+        sc.speed = 0;
+        sc.size = 2.0;
+        sc.countdownMs = 0;
+        sc.durationMs = 2000;
+        double worst = 0;
+        for (int i = 0; i < sessions; ++i)
+            worst = std::max(worst, subStepError(mode, 5000u + i, rates[i % 3]));
+        printf("sub-step scoring: worst error %.3g s over %d sessions\n", worst, sessions);
+        return mismatched || worst > 1e-6 ? 1 : 0;
+    }
+
+    // MotionEngine step and on-target test cost per pattern with N targets
+    // (reported per 1000), plus one step of a 60 s session for scale.
+    static int runMotion(int n) {
+        if (n <= 0) n = 1000;
+        const int steps = std::max(1, 20000000 / std::max(n, 1));
+        MotionEngine eng;
+        for (int p = 0; p < MOTION_COUNT; ++p) {
+            eng.reset(p, n, 40.0f, 25.0f, 20.0f, 1234 + p);
+            Uint64 t0 = SDL_GetTicksNS();
+            for (int s = 0; s < steps; ++s) eng.step();
+            Uint64 t1 = SDL_GetTicksNS();
+            long long hits = 0;
+            for (int s = 0; s < steps; ++s) hits += eng.hits(float(s % 80 - 40), float(s % 50 - 25), 3.0f);
+            Uint64 t2 = SDL_GetTicksNS();
+            double stepNs = double(t1 - t0) / steps, hitNs = double(t2 - t1) / steps;
+            printf("%-7s n=%d: step %.0f ns (%.0f ns per 1000 targets), on-target test %.0f ns"
+                " (%.0f per 1000), %.2f hits/test\n", MOTION_NAMES[p], n, stepNs, stepNs * 1000 / n,
+                hitNs, hitNs * 1000 / n, double(hits) / steps);
+        }
+        return 0;
+    }
+
+    // Score log with a long history: append N synthetic sessions, reopen
+    // (the one pass over the history, done at startup), then compare the
+    // menu's per-frame stats lookup with the old max_element scan.
+    static int runScores(int sessions) {
+        if (sessions <= 0) sessions = 1000000;
+        const char* path = "bench_scores.log";
+        SDL_RemovePath(path);
+        ScoreLog log;
+        if (!log.open(path)) return 1;
+        Rng rng;
+        std::vector<double> legacy;
+        legacy.reserve(sessions / MODE_COUNT + 1);
+        Uint64 t0 = SDL_GetTicksNS();
+        for (int i = 0; i < sessions; ++i) {
+            ScoreLog::Record r = ScoreLog::make(Uint8(i % MODE_COUNT), false, rng.uniform(0, 100));
+            log.append(r);
+            if (r.mode == MODE_GRIDSHOT) legacy.push_back(r.score);
+        }
+        Uint64 t1 = SDL_GetTicksNS();
+        ScoreLog::Stats live = log.stats[MODE_GRIDSHOT];
+        log.open(path);
+        Uint64 t2 = SDL_GetTicksNS();
+        const ScoreLog::Stats& st = log.stats[MODE_GRIDSHOT];
+        bool same = st.count == live.count && st.best == live.best &&
+            st.sum == live.sum && st.sorted == live.sorted;
+        const int frames = 100000, scanFrames = 200;
+        double sink = 0;
+        for (int f = 0; f < frames; ++f) {
+            const ScoreLog::Stats& s = log.stats[f % MODE_COUNT];
+            sink += s.best + s.mean() + s.percentile(0.5);
+        }
+        Uint64 t3 = SDL_GetTicksNS();
+        for (int f = 0; f < scanFrames; ++f)
+            sink += *std::max_element(legacy.begin(), legacy.end());
+        Uint64 t4 = SDL_GetTicksNS();
+        SDL_PathInfo info{};
+        SDL_GetPathInfo(path, &info);
+        printf("score log: %d sessions appended in %.3f s (%.2f us/append), %.1f MB\n",
+            sessions, (t1 - t0) / 1e9, (t1 - t0) / 1e3 / sessions, info.size / 1048576.0);
+        printf("reopen + rebuild aggregates: %.1f ms (%s the incremental ones)\n",
+            (t2 - t1) / 1e6, same ? "matches" : "DIFFERS from");
+        printf("menu stats lookup: %.1f ns/frame, old max_element scan: %.1f us/frame\n",
+            double(t3 - t2) / frames, (t4 - t3) / 1e3 / scanFrames);
+        printf("gridshot: %llu sessions, best %.2f, mean %.2f, p50/p90 of last %d: %.2f/%.2f\n",
+            (unsigned long long)st.count, st.best, st.mean(), int(st.sorted.size()),
+            st.percentile(0.5), st.percentile(0.9));
+        sink_ = sink;
+        log.close();
+        SDL_RemovePath(path);
+        return same ? 0 : 1;
+    }
+
+    // The loader this replaced: a newline-stripped copy of the file, then a
+    // find + substr + stod per key and per array element.
+    static void legacyLoad(std::string txt, GameConfig& cfg) {
+        txt.erase(std::remove_if(txt.begin(), txt.end(),
+            [](char c) {return c == '\n' || c == '\r' || c == '\t';}), txt.end());
+        auto scalar = [&](const char* key, double def) {
+            size_t p = txt.find(key);
+            if (p == std::string::npos) return def;
+            size_t c = txt.find(':', p);
+            size_t e = txt.find_first_of(",}", c + 1);
+            std::string num = txt.substr(c + 1, e - c - 1);
+            return num.find_first_not_of(" ") == std::string::npos ? def : std::stod(num);
             };
-        place(sensBar, sensKnob, sensVal, 0.001f, 3.0f);
-        place(fovBar, fovKnob, fovVal, 60.0f, 130.0f);
-        place(gapBar, gapKnob, float(gapVal), 0.0f, 50.0f);
-        place(lenBar, lenKnob, float(lenVal), 0.0f, 100.0f);
-        place(rBar, rKnob, float(rVal), 0.0f, 255.0f);
-        place(gBar, gKnob, float(gVal), 0.0f, 255.0f);
-        place(bBar, bKnob, float(bVal), 0.0f, 255.0f);
+        auto array = [&](const char* key, std::vector<double>& out) {
+            out.clear();
+            size_t p = txt.find(key);
+            if (p == std::string::npos) return;
+            size_t b = txt.find('[', p), e = txt.find(']', b);
+            std::string sub = txt.substr(b + 1, e - b - 1);
+            for (size_t pos = 0; pos < sub.size();) {
+                size_t c = sub.find(',', pos);
+                std::string num = sub.substr(pos, c == std::string::npos ? c : c - pos);
+                if (num.find_first_not_of(" ") != std::string::npos) out.push_back(std::stod(num));
+                if (c == std::string::npos) break;
+                pos = c + 1;
+            }
+            };
+        for (const JSONStorage::Field& fd : JSONStorage::SCHEMA) {
+            std::string key = "\"" + std::string(fd.key) + "\"";
+            if (fd.f) cfg.*fd.f = float(scalar(key.c_str(), fd.def));
+            else if (fd.i) cfg.*fd.i = int(scalar(key.c_str(), fd.def));
+            else if (fd.a) array(key.c_str(), cfg.*fd.a);
+        }
+    }
+
+    // Config load time with an mb-megabyte legacy score history, new
+    // tokenizer against the old loader, plus an error-offset sample.
+    // a config file carrying MB of legacy score arrays
+    static std::string legacyConfigText(int mb) {
+        std::string txt = "{\n  \"sensitivity\": 0.75,\n  \"fov\": 103,\n"
+            "  \"challengeMode\": false,\n  \"cross_r\": 0,\n  \"tickRate\": 1000";
+        const char* arrays[MODE_COUNT] = {
+            "gridshot_high_scores", "tracking_high_scores", "swarm_high_scores" };
+        Rng rng;
+        char num[32];
+        size_t perArray = (size_t(mb) << 20) / MODE_COUNT;
+        for (const char* key : arrays) {
+            txt += ",\n  \"";
+            txt += key;
+            txt += "\": [";
+            for (size_t start = txt.size(); txt.size() - start < perArray;) {
+                sprintf(num, "%.3f, ", rng.uniform(0, 120));
+                txt += num;
+            }
+            txt += "0]";
+        }
+        txt += "\n}\n";
+        return txt;
+    }
+
+    static int runConfig(int mb) {
+        if (mb <= 0) mb = 8;
+        const char* path = "bench_config.json";
+        std::string txt = legacyConfigText(mb);
+        {
+            std::ofstream out(path, std::ios::binary);
+            out << txt;
+        }
+        GameConfig a, b;
+        const int reps = 3;
+        Uint64 t0 = SDL_GetTicksNS();
+        bool ok = true;
+        for (int i = 0; i < reps; ++i) ok &= JSONStorage::loadConfig(a, path);
+        Uint64 t1 = SDL_GetTicksNS();
+        for (int i = 0; i < reps; ++i) legacyLoad(txt, b);
+        Uint64 t2 = SDL_GetTicksNS();
+        SDL_RemovePath(path);
+        bool same = a.gridshotScores == b.gridshotScores && a.trackingScores == b.trackingScores &&
+            a.swarmScores == b.swarmScores && a.sensitivity == b.sensitivity && a.fov == b.fov;
+        size_t values = a.gridshotScores.size() + a.trackingScores.size() + a.swarmScores.size();
+        printf("config %.1f MB, %zu scores: tokenizer %.1f ms (%.0f MB/s), old loader %.1f ms; %s\n",
+            txt.size() / 1048576.0, values, (t1 - t0) / 1e6 / reps,
+            txt.size() / 1048576.0 / ((t1 - t0) / 1e9 / reps), (t2 - t1) / 1e6 / reps,
+            ok && same ? "same values" : "VALUES DIFFER");
+        const char* bad = "{\n  \"fov\": 90,\n  \"sensitivity\": fast\n}";
+        JSONStorage::Parser parser(bad);
+        parser.parse(a);
+        printf("malformed sample: byte %zu: %s\n", parser.errorPos, parser.error ? parser.error : "no error");
+        return ok && same ? 0 : 1;
+    }
+
+    // Analytics over a long synthetic history (slowly improving, random
+    // sensitivity/FOV): per-session update cost, time to open the stats
+    // screen, and the P-square bands against exact percentiles. P-square
+    // tracks a stationary distribution closely; on a rising history like
+    // this one its outer bands lag, which is why the screen also shows the
+    // exact band over the recent window.
+    static int runStats(int sessions) {
+        if (sessions <= 0) sessions = 300000;
+        ScoreLog log;
+        Rng rng;
+        std::vector<double> grid;
+        grid.reserve(sessions / MODE_COUNT + 1);
+        Uint64 t0 = SDL_GetTicksNS();
+        for (int i = 0; i < sessions; ++i) {
+            ScoreLog::Record r{};
+            r.mode = Uint8(i % MODE_COUNT);
+            r.sensitivity = float(pow(10.0, rng.uniform(-3.0, 0.4)));
+            r.fov = float(rng.uniform(60, 130));
+            r.score = 20.0 + 15.0 * i / sessions + rng.uniform(-8, 8) + rng.uniform(-8, 8);
+            log.add(r);
+            if (r.mode == MODE_GRIDSHOT) grid.push_back(r.score);
+        }
+        Uint64 t1 = SDL_GetTicksNS();
+        StatsScreen screen;
+        screen.log = &log;
+        const int opens = 3000;
+        Uint64 worst = 0;
+        for (int i = 0; i < opens; ++i) {
+            Uint64 a = SDL_GetTicksNS();
+            screen.mode = i % MODE_COUNT;
+            screen.refresh();
+            worst = std::max(worst, SDL_GetTicksNS() - a);
+        }
+        Uint64 t2 = SDL_GetTicksNS();
+        printf("analytics: %d sessions in %.1f ms (%.0f ns/session)\n",
+            sessions, (t1 - t0) / 1e6, double(t1 - t0) / sessions);
+        printf("open stats screen: %.1f us mean, %.1f us worst\n",
+            (t2 - t1) / 1e3 / opens, worst / 1e3);
+        const SessionAnalytics& a = log.analytics[MODE_GRIDSHOT];
+        const double ps[3] = { 0.1, 0.5, 0.9 };
+        const P2Quantile* est[3] = { &a.q10, &a.q50, &a.q90 };
+        for (int k = 0; k < 3; ++k) {
+            size_t i = size_t(ps[k] * (grid.size() - 1));
+            std::nth_element(grid.begin(), grid.begin() + i, grid.end());
+            printf("gridshot p%02.0f: sketch %.3f, exact %.3f\n", ps[k] * 100, est[k]->value(), grid[i]);
+        }
+        printf("gridshot improvement: %+.3f per 100 sessions (generated %+.3f)\n",
+            a.slope() * 100, 15.0 * MODE_COUNT * 100 / sessions);
+        screen.mode = MODE_GRIDSHOT;
+        screen.refresh();
+        for (int i = 0; i < screen.lineCount; ++i) printf("  %s\n", screen.lines[i]);
+        return 0;
     }
 
-    void handleMouseDown(int mx, int my) {
-        auto start = [&](const Rect& bar, const Rect& knob, int code) {
-            if (pointInRect(mx, my, bar) || pointInRect(mx, my, knob)) {
-                dragging = code;return true;
+    // ResolutionGovernor against a synthetic software-rendered scene whose
+    // cost is a fixed part plus a part proportional to the pixel count,
+    // with +-15% noise: how fast it gets under budget, how often it changes
+    // scale once settled, and whether it climbs back when the load drops.
+    static int runGovernor(int frames) {
+        if (frames < 200) frames = 3000;
+        const Uint64 budget = SDL_NS_PER_SECOND / 144;
+        ResolutionGovernor g;
+        Rng rng;
+        double fixedNS = 1e6, pixelNS = 14e6;   // full-scale scene: 15 ms
+        int firstUnder = -1, over = 0, changes = 0;
+        float minScale = 1.0f, last = g.scale;
+        for (int f = 0; f < 2 * frames; ++f) {
+            if (f == frames) {
+                printf("heavy load: under budget after %d frames (lowest scale %.0f%%)\n",
+                    firstUnder, minScale * 100);
+                printf("heavy load: settled at %.0f%%, %d scale changes after settling, %.1f%% frames over budget\n",
+                    g.scale * 100, changes, 100.0 * over / std::max(1, frames - firstUnder - 61));
+                pixelNS /= 4;   // e.g. a lighter scene or a smaller window
+                over = changes = 0;
             }
-            return false;
-            };
-        if (start(sensBar, sensKnob, 1))return;
-        if (start(fovBar, fovKnob, 2))return;
-        if (start(gapBar, gapKnob, 3))return;
-        if (start(lenBar, lenKnob, 4))return;
-        if (start(rBar, rKnob, 5))return;
-        if (start(gBar, gKnob, 6))return;
-        if (start(bBar, bKnob, 7))return;
+            double work = (fixedNS + pixelNS * g.scale * g.scale) * rng.uniform(0.85, 1.15);
+            bool late = work > budget;
+            if (f < frames && firstUnder < 0 && !late) firstUnder = f;
+            if (firstUnder >= 0 && f < frames && f > firstUnder + 60) { over += late; changes += g.scale != last; }
+            if (f >= frames) { over += late; changes += g.scale != last; }
+            last = g.scale;
+            minScale = std::min(minScale, g.scale);
+            g.steer(Uint64(work), budget);
+        }
+        printf("light load: back at %.0f%%, %d scale changes, %.1f%% frames over budget\n",
+            g.scale * 100, changes, 100.0 * over / frames);
+        return 0;
+    }
 
-        if (pointInRect(mx, my, applyBtn))hoverBtn = 1;
-        else if (pointInRect(mx, my, resetBtn))hoverBtn = 2;
-        else if (pointInRect(mx, my, challengeBtn)) {
-            challengeVal = !challengeVal;
-            return;
+    static int runHeadless(int sessions) {
+        if (config.sensitivity < 0.001f) config.sensitivity = 1.0f;
+        if (config.fov < 60.0f)          config.fov = 90.0f;
+        syncLiveContext();
+        headlessThroughput<GridshotMode>("gridshot", sessions);
+        headlessThroughput<TrackingMode>("tracking", sessions);
+        headlessThroughput<SwarmMode>("swarm", sessions);
+        return 0;
+    }
+
+    // Expected scores: N SimPlayer sessions per drill (the classic modes and
+    // the scenarios folder) and skill level, with the saved sensitivity/FOV.
+    static int runPlayer(int sessions, const char* skillName) {
+        if (sessions <= 0) sessions = 20;
+        const SimPlayer::Skill* only = skillName ? SimPlayer::findSkill(skillName) : nullptr;
+        if (skillName && !only) {
+            fprintf(stderr, "unknown skill '%s' (novice, average, skilled, pro)\n", skillName);
+            return 2;
+        }
+        if (config.sensitivity < 0.001f) config.sensitivity = 0.05f;   // no settings: ~800 dpi
+        if (config.fov < 60.0f)          config.fov = 90.0f;
+        syncLiveContext();
+        std::vector<Scenario> drills;
+        for (int m = 0; m < MODE_COUNT; ++m) drills.push_back(Scenarios::classic(m));
+        Scenarios::Library lib;
+        lib.load();
+        drills.insert(drills.end(), lib.drills.begin(), lib.drills.end());
+        printf("sensitivity %.3f deg/count, fov %.0f, %d sessions per drill and skill\n",
+            config.sensitivity, config.fov, sessions);
+        GridshotMode grid;
+        TrackingMode track;
+        SwarmMode swarm;
+        SimPlayer player;
+        std::vector<double> scores;
+        char label[64];
+        double simulatedSec = 0;
+        Uint64 t0 = SDL_GetTicksNS();
+        for (const Scenario& d : drills) {
+            for (const SimPlayer::Skill& skill : SimPlayer::SKILLS) {
+                if (only && only != &skill) continue;
+                grid.scenario = track.scenario = swarm.scenario = d;
+                scores.clear();
+                for (int i = 0; i < sessions; ++i) {
+                    Uint64 seed = 0x9E3779B97F4A7C15ull * Uint64(i + 1);
+                    scores.push_back(d.mode == MODE_GRIDSHOT ? HeadlessSim::runPlayer(grid, player, skill, seed)
+                        : d.mode == MODE_TRACKING ? HeadlessSim::runPlayer(track, player, skill, seed)
+                        : HeadlessSim::runPlayer(swarm, player, skill, seed));
+                }
+                simulatedSec += sessions * (d.countdownMs + d.durationMs) / 1000.0;
+                snprintf(label, sizeof(label), "%s/%s", d.name, skill.name);
+                SimPlayer::printScores(label, scores);
+            }
         }
+        double sec = (SDL_GetTicksNS() - t0) / 1e9;
+        printf("%.3f s (%.0fx real time)\n", sec, simulatedSec / (sec > 0 ? sec : 1e-9));
+        return 0;
     }
-    void handleMouseUp() { dragging = 0; }
-    void handleMouseMove(int mx, int my) {
-        hoverBtn = -1;
-        hoverChallenge = pointInRect(mx, my, challengeBtn);
-        if (pointInRect(mx, my, applyBtn))hoverBtn = 1;
-        else if (pointInRect(mx, my, resetBtn))hoverBtn = 2;
 
-        if (dragging == 1) {
-            float n = (mx - sensBar.x) / float(sensBar.w);
-            n = CLAMP(n, 0.f, 1.f);
-            float lm = log10f(0.001f), lM = log10f(3.0f);
-            sensVal = powf(10.0f, lm + n * (lM - lm));
-            updateKnobs();
+    // Writes N drill files (all three modes), then times a cold load that
+    // compiles every file and writes the cache, warm loads served from the
+    // cache, and switching drills (copy the Scenario in, start the mode).
+    static int runScenarios(int n) {
+        if (n <= 0) n = 500;
+        const char* dir = "bench_scenarios";
+        const char* cache = "bench_scenarios.bin";
+        syncLiveContext();
+        SDL_CreateDirectory(dir);
+        char path[64], text[384];
+        for (int i = 0; i < n; ++i) {
+            int dur = 20000 + i % 5 * 10000;
+            if (i % MODE_COUNT == MODE_GRIDSHOT)
+                sprintf(text, "{\n  \"name\": \"Grid %d\",\n  \"mode\": \"gridshot\",\n"
+                    "  \"gridCols\": %d,\n  \"gridRows\": %d,\n  \"span\": %d,\n"
+                    "  \"size\": %.2f,\n  \"targets\": 3,\n  \"durationMs\": %d\n}\n",
+                    i, 3 + i % 6, 2 + i % 7, 18 + i % 24, 1.0 + i % 7 * 0.25, dur);
+            else if (i % MODE_COUNT == MODE_TRACKING)
+                sprintf(text, "{\n  \"name\": \"Track %d\",\n  \"mode\": \"tracking\",\n"
+                    "  \"pattern\": \"%s\",\n  \"targets\": %d,\n  \"speed\": %d,\n"
+                    "  \"size\": %.1f,\n  \"durationMs\": %d\n}\n",
+                    i, MOTION_NAMES[i % MOTION_COUNT], 1 + i % 4, 15 + i % 30, 2.0 + i % 4 * 0.5, dur);
+            else
+                sprintf(text, "{\n  \"name\": \"Swarm %d\",\n  \"mode\": \"swarm\",\n"
+                    "  \"targets\": %d,\n  \"fieldYaw\": %d,\n  \"fieldPitch\": 30,\n"
+                    "  \"size\": 0.5,\n  \"maxSize\": %.1f,\n  \"durationMs\": %d\n}\n",
+                    i, 200 + i % 10 * 300, 60 + i % 12 * 10, 1.0 + i % 3 * 0.5, dur);
+            sprintf(path, "%s/drill%05d.json", dir, i);
+            writeFileAtomic(path, text, strlen(text));
         }
-        if (dragging == 2) {
-            float n = (mx - fovBar.x) / float(fovBar.w);
-            n = CLAMP(n, 0.f, 1.f);
-            fovVal = 60.0f + n * 70.0f;
-            updateKnobs();
+        SDL_RemovePath(cache);
+        Scenarios::Library lib;
+        Uint64 t0 = SDL_GetTicksNS();
+        lib.load(dir, cache);
+        Uint64 t1 = SDL_GetTicksNS();
+        int compiled = lib.compiled, rejected = lib.rejected;
+        const int reps = 5;
+        for (int r = 0; r < reps; ++r) lib.load(dir, cache);
+        Uint64 t2 = SDL_GetTicksNS();
+        GridshotMode grid;
+        TrackingMode track;
+        SwarmMode swarm;
+        GameMode* modes[MODE_COUNT] = { &grid, &track, &swarm };
+        Uint64 worst = 0, sum = 0;
+        for (size_t i = 0; i < lib.drills.size(); ++i) {
+            GameMode& m = *modes[lib.drills[i].mode];
+            Uint64 s0 = SDL_GetTicksNS();
+            m.scenario = lib.drills[i];
+            m.seed(i);
+            m.start();
+            Uint64 d = SDL_GetTicksNS() - s0;
+            sum += d;
+            worst = std::max(worst, d);
         }
-        auto setVal = [&](int code, int mx, const Rect& bar, int& out, float mn, float mxv) {
-            if (dragging != code)return;
-            float n = (mx - bar.x) / float(bar.w);
-            n = CLAMP(n, 0.f, 1.f);
-            out = int(mn + n * (mxv - mn));
-            updateKnobs();
-            };
-        setVal(3, mx, gapBar, gapVal, 0.0f, 50.0f);
-        setVal(4, mx, lenBar, lenVal, 0.0f, 100.0f);
-        setVal(5, mx, rBar, rVal, 0.0f, 255.0f);
-        setVal(6, mx, gBar, gVal, 0.0f, 255.0f);
-        setVal(7, mx, bBar, bVal, 0.0f, 255.0f);
+        printf("%d drills: cold load %.2f ms (%d compiled, %d rejected, cache write included)\n",
+            n, (t1 - t0) / 1e6, compiled, rejected);
+        printf("warm load %.2f ms (%d from cache, %d compiled), %.2f us/drill\n",
+            (t2 - t1) / 1e6 / reps, lib.cached, lib.compiled, (t2 - t1) / 1e3 / reps / std::max(n, 1));
+        printf("switch + start: mean %.1f us, worst %.1f us\n",
+            sum / 1e3 / std::max<size_t>(lib.drills.size(), 1), worst / 1e3);
+        for (int i = 0; i < n; ++i) {
+            sprintf(path, "%s/drill%05d.json", dir, i);
+            SDL_RemovePath(path);
+        }
+        SDL_RemovePath(dir);
+        SDL_RemovePath(cache);
+        return rejected || lib.compiled ? 1 : 0;
     }
 
-    void apply() {
-        config.sensitivity = sensVal;
-        config.fov = fovVal;
-        config.cross_gap = gapVal;
-        config.cross_len = lenVal;
-        config.cross_r = rVal;
-        config.cross_g = gVal;
-        config.cross_b = bVal;
-        config.challengeMode = challengeVal;
-        JSONStorage::saveConfig(config);
+    // --- Benchmark suite (aimtrainer_bench, --bench-suite) ---
+    // Fixed workloads over the hot paths. Each case runs one warm-up batch
+    // and then `samples` timed batches; results are ns per operation for
+    // the median, fastest and slowest batch. The JSON report goes to stdout
+    // (or --json PATH), progress to stderr. --baseline PATH compares the
+    // medians with an earlier report and fails when any case got more than
+    // --tolerance percent (default 10) slower.
+    struct Result {
+        std::string name;
+        long long ops;               // operations per batch
+        double median, min, max;     // ns per operation
+        double baseline = 0;         // median in the baseline report, 0 if none
+    };
+
+    template<class F>
+    static Result measure(const char* name, long long ops, int samples, F&& batch) {
+        batch();
+        std::vector<double> t(samples);
+        for (double& s : t) {
+            Uint64 t0 = SDL_GetTicksNS();
+            batch();
+            s = double(SDL_GetTicksNS() - t0) / ops;
+        }
+        std::sort(t.begin(), t.end());
+        fprintf(stderr, "%-24s %12.1f ns/op (min %.1f, max %.1f)\n", name, t[samples / 2], t[0], t.back());
+        return { name, ops, t[samples / 2], t[0], t.back() };
     }
 
-    void reset() {
-        sensVal = config.sensitivity;
-        fovVal = config.fov;
-        gapVal = config.cross_gap;
-        lenVal = config.cross_len;
-        rVal = config.cross_r;
-        gVal = config.cross_g;
-        bVal = config.cross_b;
-        challengeVal = config.challengeMode;
-        updateKnobs();
+    // One frame per mode (snapshot, world, crosshair, HUD text, present) on
+    // SDL's software renderer under the offscreen video driver, so it needs
+    // no display or GPU.
+    template<class Mode>
+    static Result frame(const char* name, Mode& mode, SDL_Renderer* ren, int samples) {
+        const int frames = 20;
+        mode.seed(1);
+        mode.start();
+        mode.update(SDL_MS_TO_NS(mode.scenario.countdownMs), 0, 0);
+        Snapshot s;
+        s.viewYaw = float(liveContext.proj.hFov / 2);
+        s.viewPitch = float(liveContext.proj.vFov / 2);
+        double cy = 0;
+        return measure(name, frames, samples, [&] {
+            for (int f = 0; f < frames; ++f) {
+                s.prevYaw = s.camYaw = cy = fmod(cy + 0.7, 360.0);
+                mode.snapshot(s);
+                mode.render(ren, s, 1.0f);
+                batch.endFrame();
+                textCache.endFrame();
+                SDL_RenderPresent(ren);
+            }
+            });
+    }
+    static void frameCases(std::vector<Result>& out, int samples) {
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+        if (!SDL_Init(SDL_INIT_VIDEO)) {
+            fprintf(stderr, "frame cases skipped: SDL_Init failed: %s\n", SDL_GetError());
+            return;
+        }
+        SDL_Window* win = SDL_CreateWindow("aimtrainer_bench", DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT, 0);
+        SDL_Renderer* ren = win ? SDL_CreateRenderer(win, SDL_SOFTWARE_RENDERER) : nullptr;
+        if (ren) {
+            View live = view;
+            syncView(win, ren);
+            GridshotMode grid;
+            TrackingMode track;
+            SwarmMode swarm;
+            out.push_back(frame("frame.gridshot", grid, ren, samples));
+            out.push_back(frame("frame.tracking", track, ren, samples));
+            out.push_back(frame("frame.swarm", swarm, ren, samples));
+            textCache.clear();
+            governor.release();
+            view = live;
+            syncLiveContext();
+        }
+        else fprintf(stderr, "frame cases skipped: no software renderer: %s\n", SDL_GetError());
+        if (ren) SDL_DestroyRenderer(ren);
+        if (win) SDL_DestroyWindow(win);
+        SDL_Quit();
     }
 
-    void render(SDL_Renderer* ren) {
-        SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
-        SDL_RenderClear(ren);
-        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
-        char buf[64];
-        // Sensitivity
-        SDL_RenderDebugText(ren,
-            sensBar.x, sensBar.y - 15, "Mouse Sensitivity");
-        drawRect(ren,
-            sensBar.x, sensBar.y, sensBar.w, sensBar.h, { 200,200,200,255 });
-        drawRect(ren,
-            sensKnob.x, sensKnob.y, sensKnob.w, sensKnob.h, { 255,255,255,255 });
-        sprintf(buf, "%.3f", sensVal);
-        SDL_RenderDebugText(ren,
-            sensBar.x + sensBar.w + 10, sensBar.y - 4, buf);
-        // FOV
-        SDL_RenderDebugText(ren,
-            fovBar.x, fovBar.y - 15, "Field of View");
-        drawRect(ren,
-            fovBar.x, fovBar.y, fovBar.w, fovBar.h, { 200,200,200,255 });
-        drawRect(ren,
-            fovKnob.x, fovKnob.y, fovKnob.w, fovKnob.h, { 255,255,255,255 });
-        sprintf(buf, "%.0f", fovVal);
-        SDL_RenderDebugText(ren,
-            fovBar.x + fovBar.w + 10, fovBar.y - 4, buf);
-        // Gap
-        SDL_RenderDebugText(ren,
-            gapBar.x, gapBar.y - 15, "Crosshair Gap");
-        drawRect(ren,
-            gapBar.x, gapBar.y, gapBar.w, gapBar.h, { 200,200,200,255 });
-        drawRect(ren,
-            gapKnob.x, gapKnob.y, gapKnob.w, gapKnob.h, { 255,255,255,255 });
-        sprintf(buf, "%d", gapVal);
-        SDL_RenderDebugText(ren,
-            gapBar.x + gapBar.w + 10, gapBar.y - 4, buf);
-        // Length
-        SDL_RenderDebugText(ren,
-            lenBar.x, lenBar.y - 15, "Crosshair Length");
-        drawRect(ren,
-            lenBar.x, lenBar.y, lenBar.w, lenBar.h, { 200,200,200,255 });
-        drawRect(ren,
-            lenKnob.x, lenKnob.y, lenKnob.w, lenKnob.h, { 255,255,255,255 });
-        sprintf(buf, "%d", lenVal);
-        SDL_RenderDebugText(ren,
-            lenBar.x + lenBar.w + 10, lenBar.y - 4, buf);
-        // R
-        SDL_RenderDebugText(ren,
-            rBar.x, rBar.y - 15, "Crosshair R");
-        drawRect(ren,
-            rBar.x, rBar.y, rBar.w, rBar.h, { 200,200,200,255 });
-        drawRect(ren,
-            rKnob.x, rKnob.y, rKnob.w, rKnob.h, { 255,255,255,255 });
-        sprintf(buf, "%d", rVal);
-        SDL_RenderDebugText(ren,
-            rBar.x + rBar.w + 10, rBar.y - 4, buf);
-        // G
-        SDL_RenderDebugText(ren,
-            gBar.x, gBar.y - 15, "Crosshair G");
-        drawRect(ren,
-            gBar.x, gBar.y, gBar.w, gBar.h, { 200,200,200,255 });
-        drawRect(ren,
-            gKnob.x, gKnob.y, gKnob.w, gKnob.h, { 255,255,255,255 });
-        sprintf(buf, "%d", gVal);
-        SDL_RenderDebugText(ren,
-            gBar.x + gBar.w + 10, gBar.y - 4, buf);
-        // B
-        SDL_RenderDebugText(ren,
-            bBar.x, bBar.y - 15, "Crosshair B");
-        drawRect(ren,
-            bBar.x, bBar.y, bBar.w, bBar.h, { 200,200,200,255 });
-        drawRect(ren,
-            bKnob.x, bKnob.y, bKnob.w, bKnob.h, { 255,255,255,255 });
-        sprintf(buf, "%d", bVal);
-        SDL_RenderDebugText(ren,
-            bBar.x + bBar.w + 10, bBar.y - 4, buf);
-        // Challenge Mode toggle
-        SDL_Color baseBtn{ 100,100,100,255 }, hovBtn{ 150,150,150,255 };
-        drawRect(ren,
-            challengeBtn.x, challengeBtn.y,
-            challengeBtn.w, challengeBtn.h,
-            hoverChallenge ? hovBtn : baseBtn);
-        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
-        sprintf(buf, "Challenge Mode: %s",
-            challengeVal ? "ON" : "OFF");
-        SDL_RenderDebugText(ren,
-            challengeBtn.x + 10, challengeBtn.y + 10, buf);
-        // Apply & Reset
-        drawRect(ren,
-            applyBtn.x, applyBtn.y,
-            applyBtn.w, applyBtn.h,
-            hoverBtn == 1 ? hovBtn : baseBtn);
-        drawRect(ren,
-            resetBtn.x, resetBtn.y,
-            resetBtn.w, resetBtn.h,
-            hoverBtn == 2 ? hovBtn : baseBtn);
-        SDL_RenderDebugText(ren,
-            applyBtn.x + 20, applyBtn.y + 10, "Apply");
-        SDL_RenderDebugText(ren,
-            resetBtn.x + 20, resetBtn.y + 10, "Reset");
+    // medians by case name from an earlier report
+    static bool readBaseline(const char* path, std::unordered_map<std::string, double>& medians) {
+        std::string txt;
+        if (!readFile(path, txt)) return false;
+        JSONStorage::Parser p(txt);
+        bool ok = p.object([&](std::string_view key) {
+            if (key != "results") return p.skip(0);
+            return p.array([&] {
+                std::string_view name;
+                double median = -1;
+                if (!p.object([&](std::string_view k) {
+                    if (k == "name") return p.string(name);
+                    if (k == "median") return p.number(median);
+                    return p.skip(0);
+                    }))
+                    return false;
+                if (median >= 0) medians[std::string(name)] = median;
+                return true;
+                });
+            });
+        if (!ok) fprintf(stderr, "%s: byte %zu: %s\n", path, p.errorPos, p.error);
+        return ok;
     }
-};
 
-// --- CreditsScreen ---
-class CreditsScreen {
-public:
-    void render(SDL_Renderer* ren) {
-        SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
-        SDL_RenderClear(ren);
-        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
-        SDL_RenderDebugText(ren,
-            WINDOW_WIDTH / 2 - 50, WINDOW_HEIGHT / 2 - 4,
-            "FPS Aim Trainer v1.0");
-        SDL_RenderDebugText(ren,
-            WINDOW_WIDTH / 2 - 80, WINDOW_HEIGHT / 2 + 12,
-            "by Xavier Seron, Ceaser Fandino, David Rodriguez");
-        SDL_RenderDebugText(ren,
-            WINDOW_WIDTH / 2 - 60, WINDOW_HEIGHT / 2 + 40,
-            "(Click or press any key)");
+    static int runSuite(int argc, char** argv) {
+        const char* jsonPath = nullptr;
+        const char* baselinePath = nullptr;
+        int samples = 15;
+        double tolerance = 10;
+        for (int i = 0; i < argc; ++i) {
+            if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonPath = argv[++i];
+            else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) baselinePath = argv[++i];
+            else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) samples = std::max(1, atoi(argv[++i]));
+            else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) tolerance = atof(argv[++i]);
+            else {
+                fprintf(stderr, "usage: [--json PATH] [--baseline PATH] [--tolerance PCT] [--samples N]\n");
+                return 2;
+            }
+        }
+        // defaults, not the player's config, so runs are comparable
+        JSONStorage::setDefaults(config);
+        config.fov = 103.0f;
+        view = View{};
+        syncLiveContext();
+        std::vector<Result> out;
+        double acc = 0;
+
+        const int n = 10000;
+        std::vector<float> dy(n), dp(n), sx(n), sy(n);
+        std::vector<int> vis(n);
+        Uint32 seed = 7;
+        for (int i = 0; i < n; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            dy[i] = (seed >> 8) / float(1 << 24) * 180.0f - 90.0f;
+            seed = seed * 1664525u + 1013904223u;
+            dp[i] = (seed >> 8) / float(1 << 24) * 120.0f - 60.0f;
+        }
+        out.push_back(measure("projection.project", n, samples, [&] {
+            for (int i = 0; i < n; ++i) {
+                int x, y;
+                if (liveContext.proj.project(dy[i], dp[i], 5.0, x, y)) acc += x + y;
+            }
+            }));
+        out.push_back(measure("projection.batch", n, samples, [&] {
+            acc += liveContext.proj.projectBatch(dy.data(), dp.data(), n, 5.0f, sx.data(), sy.data(), vis.data());
+            }));
+
+        // cycles through the cell centres, so clicks mix hits and misses
+        GridshotMode grid;
+        grid.seed(1);
+        grid.start();
+        const int clicks = 9000;
+        out.push_back(measure("gridshot.handleClick", clicks, samples, [&] {
+            for (int i = 0; i < clicks; ++i) {
+                int c = i % 9;
+                acc += grid.handleClick((c % 3 - 1) * 15.0, (1 - c / 3) * 15.0);
+            }
+            }));
+        // the same with every shot logged (live sessions)
+        ShotLog shots;
+        grid.shots = &shots;
+        out.push_back(measure("gridshot.handleClick.telemetry", clicks, samples, [&] {
+            shots.begin(clicks * 1000 / ShotLog::MAX_CLICKS_PER_SEC, 0, 0);
+            for (int i = 0; i < clicks; ++i) {
+                int c = i % 9;
+                acc += grid.handleClick((c % 3 - 1) * 15.0, (1 - c / 3) * 15.0);
+            }
+            }));
+
+        SwarmMode swarm;
+        swarm.seed(1);
+        swarm.start();
+        Rng rng;
+        std::vector<double> cy(clicks), cp(clicks);
+        for (int i = 0; i < clicks; ++i) {
+            cy[i] = rng.uniform(0, 360);
+            cp[i] = rng.uniform(-45, 45);
+        }
+        out.push_back(measure("swarm.handleClick", clicks, samples, [&] {
+            for (int i = 0; i < clicks; ++i) acc += swarm.handleClick(cy[i], cp[i]);
+            }));
+        swarm.shots = &shots;
+        out.push_back(measure("swarm.handleClick.telemetry", clicks, samples, [&] {
+            shots.begin(clicks * 1000 / ShotLog::MAX_CLICKS_PER_SEC, 0, 0);
+            for (int i = 0; i < clicks; ++i) acc += swarm.handleClick(cy[i], cp[i]);
+            }));
+
+        // 10 s of 1 ms ticks with the aim moving every tick (session start
+        // included); one case per motion pattern is left to --bench-motion
+        TrackingMode track;
+        track.scenario.targets = 4;
+        const int ticks = 10000;
+        out.push_back(measure("tracking.update", ticks, samples, [&] {
+            track.seed(1);
+            track.start();
+            track.update(SDL_MS_TO_NS(track.scenario.countdownMs), 0, 0);
+            for (int i = 0; i < ticks; ++i) {
+                double a = i * 0.002;
+                track.update(SDL_NS_PER_MS, 20 * sin(a), 8 * cos(a * 1.3));
+            }
+            acc += track.getScore();
+            }));
+
+        // the JSON file with 8 MB of legacy score history, and a settings save
+        const char* cfgPath = "bench_suite_config.json";
+        std::string txt = legacyConfigText(8);
+        writeFileAtomic(cfgPath, txt.data(), txt.size());
+        GameConfig cfg;
+        out.push_back(measure("json.load_8mb", 1, samples, [&] {
+            acc += JSONStorage::loadConfig(cfg, cfgPath);
+            }));
+        out.push_back(measure("json.save", 1, samples, [&] {
+            acc += JSONStorage::saveConfig(config, cfgPath);
+            }));
+        SDL_RemovePath(cfgPath);
+
+        frameCases(out, samples);
+        sink_ = acc;
+
+        std::unordered_map<std::string, double> medians;
+        int slower = 0;
+        if (baselinePath && !readBaseline(baselinePath, medians)) {
+            fprintf(stderr, "Could not read baseline %s\n", baselinePath);
+            return 2;
+        }
+        for (Result& r : out) {
+            auto it = medians.find(r.name);
+            if (it == medians.end() || it->second <= 0) continue;
+            r.baseline = it->second;
+            double change = (r.median / r.baseline - 1) * 100;
+            if (change > tolerance) {
+                ++slower;
+                fprintf(stderr, "SLOWER: %s %.1f -> %.1f ns/op (%+.1f%%)\n",
+                    r.name.c_str(), r.baseline, r.median, change);
+            }
+        }
+
+        char line[256];
+        std::string json = "{\n";
+#if defined(__clang__)
+        snprintf(line, sizeof(line), "  \"compiler\": \"clang %s\",\n", __clang_version__);
+#elif defined(__GNUC__)
+        snprintf(line, sizeof(line), "  \"compiler\": \"gcc %s\",\n", __VERSION__);
+#elif defined(_MSC_VER)
+        snprintf(line, sizeof(line), "  \"compiler\": \"MSVC %d\",\n", _MSC_VER);
+#else
+        snprintf(line, sizeof(line), "  \"compiler\": \"unknown\",\n");
+#endif
+        json += line;
+#ifdef NDEBUG
+        json += "  \"build\": \"release\",\n";
+#else
+        json += "  \"build\": \"debug\",\n";
+#endif
+        int v = SDL_GetVersion();
+        snprintf(line, sizeof(line), "  \"sdl\": \"%d.%d.%d\",\n  \"time\": %lld,\n  \"samples\": %d,\n",
+            SDL_VERSIONNUM_MAJOR(v), SDL_VERSIONNUM_MINOR(v), SDL_VERSIONNUM_MICRO(v),
+            (long long)time(nullptr), samples);
+        json += line;
+        json += "  \"unit\": \"ns/op\",\n  \"results\": [";
+        for (size_t i = 0; i < out.size(); ++i) {
+            const Result& r = out[i];
+            snprintf(line, sizeof(line), "%s\n    { \"name\": \"%s\", \"ops\": %lld, \"median\": %.3f, "
+                "\"min\": %.3f, \"max\": %.3f", i ? "," : "", r.name.c_str(), r.ops, r.median, r.min, r.max);
+            json += line;
+            if (r.baseline > 0) {
+                snprintf(line, sizeof(line), ", \"baseline\": %.3f", r.baseline);
+                json += line;
+            }
+            json += " }";
+        }
+        json += "\n  ]\n}\n";
+        if (jsonPath) {
+            if (!writeFileAtomic(jsonPath, json.data(), json.size())) {
+                fprintf(stderr, "Could not write %s\n", jsonPath);
+                return 2;
+            }
+        }
+        else fputs(json.c_str(), stdout);
+        return slower ? 1 : 0;
     }
-};
+}
 
 int main(int argc, char* argv[]) {
     SDL_SetMainReady();
+#ifdef AIMTRAINER_BENCH_MAIN
+    return Bench::runSuite(argc - 1, argv + 1);
+#endif
+    if (argc > 1 && strcmp(argv[1], "--bench-suite") == 0)
+        return Bench::runSuite(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "--bench-headless") == 0) {
+        JSONStorage::loadConfig(config);
+        return Bench::runHeadless(argc > 2 ? atoi(argv[2]) : 2000);
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-projection") == 0)
+        return Bench::runProjection(argc > 2 ? atoi(argv[2]) : 10000);
+    if (argc > 1 && strcmp(argv[1], "--bench-swarm") == 0)
+        return Bench::runSwarm(argc > 2 ? atoi(argv[2]) : 100000);
+    if (argc > 1 && strcmp(argv[1], "--bench-config") == 0)
+        return Bench::runConfig(argc > 2 ? atoi(argv[2]) : 8);
+    if (argc > 1 && strcmp(argv[1], "--bench-stats") == 0)
+        return Bench::runStats(argc > 2 ? atoi(argv[2]) : 300000);
+    if (argc > 1 && strcmp(argv[1], "--bench-motion") == 0)
+        return Bench::runMotion(argc > 2 ? atoi(argv[2]) : 1000);
+    if (argc > 1 && strcmp(argv[1], "--bench-scenarios") == 0)
+        return Bench::runScenarios(argc > 2 ? atoi(argv[2]) : 500);
+    if (argc > 1 && strcmp(argv[1], "--bench-governor") == 0)
+        return Bench::runGovernor(argc > 2 ? atoi(argv[2]) : 3000);
+    if (argc > 1 && strcmp(argv[1], "--bench-scores") == 0)
+        return Bench::runScores(argc > 2 ? atoi(argv[2]) : 1000000);
+    if (argc > 1 && strcmp(argv[1], "--bench-player") == 0) {
+        JSONStorage::loadConfig(config);
+        return Bench::runPlayer(argc > 2 ? atoi(argv[2]) : 20, argc > 3 ? argv[3] : nullptr);
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-tracking") == 0) {
+        JSONStorage::loadConfig(config);
+        return Bench::runTracking(argc > 2 ? atoi(argv[2]) : 200);
+    }
+    if (argc > 1 && strcmp(argv[1], "--replay") == 0)
+        return Replay::run(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "--shots") == 0)
+        return Telemetry::run(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "--trace-latency") == 0)
+        return Trace::runLatency(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "--sweep") == 0) {
+        JSONStorage::loadConfig(config);
+        return Sweep::run(argc - 2, argv + 2);
+    }
+    // --soak: the game plays itself (SimPlayer) through the drills
+    const SimPlayer::Skill* soakSkill = nullptr;
+    double soakMinutes = 0;
+    if (argc > 1 && strcmp(argv[1], "--soak") == 0) {
+        soakMinutes = argc > 2 ? atof(argv[2]) : 60;
+        if (soakMinutes <= 0) soakMinutes = 60;
+        soakSkill = SimPlayer::findSkill(argc > 3 ? argv[3] : "average");
+        if (!soakSkill) {
+            fprintf(stderr, "unknown skill '%s' (novice, average, skilled, pro)\n", argv[3]);
+            return 2;
+        }
+    }
     if (!SDL_Init(SDL_INIT_VIDEO)) {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
             "SDL_Init failed: %s", SDL_GetError());
@@ -757,156 +5731,465 @@ int main(int argc, char* argv[]) {
     SDL_Renderer* renderer = nullptr;
     if (!SDL_CreateWindowAndRenderer(
         "FPS Aim Trainer",
-        WINDOW_WIDTH, WINDOW_HEIGHT,
-        0, &window, &renderer))
+        DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT,
+        SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY, &window, &renderer))
     {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
             "Window/Renderer failed: %s", SDL_GetError());
         SDL_Quit();
         return 1;
     }
+    Trace::nameThread("main");
     JSONStorage::loadConfig(config);
     if (config.sensitivity < 0.001f) config.sensitivity = 1.0f;
     if (config.fov < 60.0f)          config.fov = 90.0f;
+    if (config.tickRate <= 0)        config.tickRate = 1000;
+    if (config.pacingMode < 0 || config.pacingMode >= PACE_COUNT)
+        config.pacingMode = PACE_CAPPED;
+    if (config.trackPattern < 0 || config.trackPattern >= MOTION_COUNT)
+        config.trackPattern = MOTION_BOUNCE;
+    config.trackTargets = CLAMP(config.trackTargets, 1, MAX_TRACK_TARGETS);
+    scoreLog.open(SCORE_LOG);
+    bool migrated = scoreLog.migrate(config);
+    persist.start();
+    if (migrated) persist.saveConfig(config);
+    if (config.fullscreen) SDL_SetWindowFullscreen(window, true);
+    syncView(window, renderer);
+    syncLiveContext();
     MainMenu      menu;
     GridshotMode  grid;
     TrackingMode  track;
+    SwarmMode     swarm;
     SettingsMenu  settings;
     CreditsScreen credits;
-    enum State { MAIN, GRID, TRACK, SETT, CRED } state = MAIN;
+    StatsScreen   stats;
+    DrillMenu     drillMenu;
+    Scenarios::Library library;
+    library.load();
+    drillMenu.setDrills(library.drills);
+    enum State { MAIN, GRID, TRACK, SWARM, STATS, SETT, CRED, DRILL } state = MAIN;
+    const State MODE_STATE[MODE_COUNT] = { GRID, TRACK, SWARM };
+    GameMode* const modes[MODE_COUNT] = { &grid, &track, &swarm };
     double camYaw = 0, camPitch = 0;
     SDL_SetWindowRelativeMouseMode(window, false);
+    PerfHUD perf;
+    FramePacer pacer;
+    pacer.calibrate();
+    pacer.apply(renderer, config.pacingMode, config.fpsCap);
     bool quit = false;
-    Uint32 prev = SDL_GetTicks();
-    while (!quit) {
-        Uint32 now = SDL_GetTicks();
-        Uint32 delta = now - prev; if (delta > 33) delta = 33;
-        prev = now;
-        SDL_Event e;
-        while (SDL_PollEvent(&e)) {
-            if (e.type == SDL_EVENT_QUIT) quit = true;
-            else if (state == MAIN) {
-                if (e.type == SDL_EVENT_MOUSE_MOTION)
-                    menu.updateHover(e.motion.x, e.motion.y);
-                else if (e.type == SDL_EVENT_MOUSE_BUTTON_DOWN) {
-                    int mx = e.button.x, my = e.button.y;
-                    if (pointInRect(mx, my, menu.btns[0])) {
-                        state = GRID;
-                        SDL_SetWindowRelativeMouseMode(window, true);
-                        if (config.challengeMode) grid.toggleChallengeMode();
-                        grid.start();
-                    }
-                    else if (pointInRect(mx, my, menu.btns[1])) {
-                        state = TRACK;
-                        SDL_SetWindowRelativeMouseMode(window, true);
-                        if (config.challengeMode) track.toggleChallengeMode();
-                        track.start();
-                    }
-                    else if (pointInRect(mx, my, menu.btns[2])) {
-                        state = SETT;
-                        settings = SettingsMenu();
-                        SDL_SetWindowRelativeMouseMode(window, false);
-                    }
-                    else if (pointInRect(mx, my, menu.btns[3])) {
-                        state = CRED;
-                        SDL_SetWindowRelativeMouseMode(window, false);
+    FixedStepClock simClock;
+    simClock.setRate(config.tickRate);
+    simClock.reset(SDL_GetTicksNS());
+    SDL_AddEventWatch(captureMouseEvent, &inputRing);
+    Replay::Recorder recorder;
+    ShotLog shotLog;
+    grid.shots = swarm.shots = &shotLog;
+    // Sessions tick on SimThread in a copy of liveContext taken at the
+    // start; render() draws the snapshots into the live view.
+    SimThread sim;
+    SessionContext sessionContext;
+    grid.ctx = track.ctx = swarm.ctx = &sessionContext;
+    SessionMode session = MODE_GRIDSHOT;
+    Uint32 sessionSeq = 0;
+    // Soak: SimPlayer cycles the classic modes and the custom drills. Its
+    // input goes through captureMouseEvent like the real mouse; scores stay
+    // out of the log, and each session is replayed from an encoded copy of
+    // its recording to check the live and replayed scores agree.
+    SimPlayer bot;
+    std::vector<TargetInfo> botTargets;
+    std::vector<Scenario> soakDrills;
+    std::vector<std::vector<double>> soakScores;
+    size_t soakNext = 0;
+    int soakMismatched = 0;
+    Uint64 soakEnd = 0;
+    Replay::Player soakReplay;
+    if (soakSkill) {
+        for (int m = 0; m < MODE_COUNT; ++m) soakDrills.push_back(Scenarios::classic(m));
+        soakDrills.insert(soakDrills.end(), library.drills.begin(), library.drills.end());
+        soakScores.resize(soakDrills.size());
+        soakEnd = SDL_GetTicksNS() + Uint64(soakMinutes * 60e9);
+        SDL_Log("Soak: %.0f min as a %s player over %zu drills",
+            soakMinutes, soakSkill->name, soakDrills.size());
+    }
+
+    auto publish = [&] {
+        TRACE_SCOPE("snapshot");
+        Snapshot& snap = sim.snapshots.begin(sessionSeq, simClock.tickWallNS, camYaw, camPitch);
+        snap.inputs = Trace::consumedCount();
+        snap.viewYaw = sim.viewYaw.load(std::memory_order_relaxed);
+        snap.viewPitch = sim.viewPitch.load(std::memory_order_relaxed);
+        modes[session]->snapshot(snap);
+        sim.snapshots.publish();
+    };
+    // a session's mouse input, fed from inputRing; into is how far into the
+    // coming tick the event happened
+    auto sessionMouse = [&](const InputEvent& in, Uint64 into) {
+        if (session == MODE_GRIDSHOT) {
+            if (in.type == SDL_EVENT_MOUSE_MOTION &&
+                !grid.isInCountdown(into)) {
+                applyMouseMotion(camYaw, camPitch, in.xrel, in.yrel, sessionContext.sensitivity);
+                recorder.motion(into, in.xrel, in.yrel);
+            }
+            else if (in.type == SDL_EVENT_MOUSE_BUTTON_DOWN &&
+                !grid.isInCountdown(into) &&
+                in.button == SDL_BUTTON_LEFT) {
+                grid.handleClick(camYaw, camPitch, into);
+                recorder.click(into);
+            }
+        }
+        else if (session == MODE_SWARM) {
+            if (in.type == SDL_EVENT_MOUSE_MOTION &&
+                !swarm.isInCountdown(into)) {
+                applyMouseMotion(camYaw, camPitch, in.xrel, in.yrel, sessionContext.sensitivity);
+                recorder.motion(into, in.xrel, in.yrel);
+            }
+            else if (in.type == SDL_EVENT_MOUSE_BUTTON_DOWN &&
+                !swarm.isInCountdown(into) &&
+                in.button == SDL_BUTTON_LEFT) {
+                swarm.handleClick(camYaw, camPitch, into);
+                recorder.click(into);
+            }
+        }
+        else if (session == MODE_TRACKING) {
+            if (in.type == SDL_EVENT_MOUSE_MOTION &&
+                !track.isInCountdown(into)) {
+                applyMouseMotion(camYaw, camPitch, in.xrel, in.yrel, sessionContext.sensitivity);
+                track.aim(into, camYaw, camPitch);
+                recorder.motion(into, in.xrel, in.yrel);
+            }
+        }
+    };
+    // One wake of the simulation thread: the ticks due by now, each taking
+    // the mouse events timestamped before it ends, then a snapshot.
+    auto stepSession = [&](Uint64 now) -> Uint64 {
+        Uint32 ticks = simClock.advance(now);
+        if (soakSkill) {
+            // the player sees the current targets; its input up to the end
+            // of the ticks about to run enters the ring like mouse input
+            modes[session]->listTargets(camYaw, camPitch, botTargets);
+            bot.advance(simClock.tickWallNS + ticks * simClock.tickNS, botTargets,
+                [&](Uint64 t, Uint32 type, float xrel, float yrel) {
+                    SDL_Event ev{};
+                    ev.type = type;
+                    ev.common.timestamp = t;
+                    if (type == SDL_EVENT_MOUSE_MOTION) {
+                        ev.motion.xrel = xrel;
+                        ev.motion.yrel = yrel;
                     }
+                    else ev.button.button = SDL_BUTTON_LEFT;
+                    captureMouseEvent(&inputRing, &ev);
+                });
+        }
+        bool over = false;
+        InputEvent in;
+        for (Uint32 i = 0; i < ticks && !over; ++i) {
+            Uint64 tickEnd = simClock.nextTick();
+            Uint64 tickStart = tickEnd - simClock.tickNS;
+            {
+                TRACE_SCOPE("tick.input");
+                while (inputRing.peek(in) && in.timeNS <= tickEnd) {
+                    inputRing.pop();
+                    sessionMouse(in, in.timeNS > tickStart ? in.timeNS - tickStart : 0);
+                    Trace::consumed(in.timeNS);
                 }
-                else if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_ESCAPE)
-                    quit = true;
-            }
-            else if (state == GRID) {
-                if (e.type == SDL_EVENT_MOUSE_MOTION &&
-                    !grid.isInCountdown()) {
-                    camYaw += e.motion.xrel * config.sensitivity;
-                    camPitch -= e.motion.yrel * config.sensitivity;
-                    camPitch = CLAMP(camPitch, -89.0, 89.0);
-                    if (camYaw < 0) camYaw += 360; if (camYaw >= 360) camYaw -= 360;
+            }
+            if (session == MODE_GRIDSHOT) {
+                grid.update(simClock.tickNS, camYaw, camPitch);
+                over = !grid.isRunning();
+            }
+            else if (session == MODE_TRACKING) {
+                track.update(simClock.tickNS, camYaw, camPitch);
+                over = !track.isRunning();
+            }
+            else {
+                swarm.update(simClock.tickNS, camYaw, camPitch);
+                over = !swarm.isRunning();
+            }
+            recorder.endTick();
+        }
+        if (soakSkill && !over) bot.sync(camYaw, camPitch);
+        // woken early: nothing new, and a second snapshot of the same
+        // moment would leave the render thread nothing to blend from
+        if (ticks) publish();
+        return over ? 0 : simClock.tickWallNS + simClock.tickNS;
+    };
+    sim.start(stepSession);
+    sim.setView(liveContext.proj);
+
+    // Sets the session up and hands it to the simulation thread, which
+    // owns the modes, the camera, recorder, shotLog, bot and the input
+    // ring's read side until sim.stop().
+    auto startSession = [&](const Scenario& drill) {
+        GameMode& mode = *modes[drill.mode];
+        session = SessionMode(drill.mode);
+        state = MODE_STATE[drill.mode];
+        mode.scenario = drill;
+        SDL_SetWindowRelativeMouseMode(window, true);
+        if (config.challengeMode) mode.toggleChallengeMode();
+        sessionContext = liveContext;
+        Uint64 seed = SDL_GetPerformanceCounter() ^ SDL_GetTicksNS();
+        mode.seed(seed);
+        mode.start();
+        Uint64 now = SDL_GetTicksNS();
+        simClock.reset(now);
+        recorder.begin(session, mode, seed, simClock.tickNS, camYaw, camPitch);
+        shotLog.begin(drill.durationMs, camYaw, camPitch);
+        if (soakSkill)
+            bot.begin(*soakSkill, now, drill.mode == MODE_TRACKING, sessionContext.sensitivity,
+                now + SDL_MS_TO_NS(drill.countdownMs + 2), camYaw, camPitch);
+        ++sessionSeq;
+        publish();   // the first frame has a snapshot to draw
+        sim.run();
+    };
+    // per-state mouse handling of the menus, fed from inputRing
+    auto dispatchMouse = [&](const InputEvent& in) {
+        int mx = view.toUi(in.x), my = view.toUi(in.y);
+        if (state == MAIN) {
+            if (in.type == SDL_EVENT_MOUSE_MOTION)
+                menu.updateHover(mx, my);
+            else if (in.type == SDL_EVENT_MOUSE_BUTTON_DOWN) {
+                if (pointInRect(mx, my, menu.btns[MainMenu::BTN_GRID]))
+                    startSession(Scenarios::classic(MODE_GRIDSHOT));
+                else if (pointInRect(mx, my, menu.btns[MainMenu::BTN_TRACK]))
+                    startSession(Scenarios::classic(MODE_TRACKING));
+                else if (pointInRect(mx, my, menu.btns[MainMenu::BTN_SWARM]))
+                    startSession(Scenarios::classic(MODE_SWARM));
+                else if (pointInRect(mx, my, menu.btns[MainMenu::BTN_DRILL]))
+                    state = DRILL;
+                else if (pointInRect(mx, my, menu.btns[MainMenu::BTN_STATS]))
+                    state = STATS;
+                else if (pointInRect(mx, my, menu.btns[MainMenu::BTN_SETT])) {
+                    state = SETT;
+                    settings = SettingsMenu();
+                    SDL_SetWindowRelativeMouseMode(window, false);
                 }
-                else if (e.type == SDL_EVENT_MOUSE_BUTTON_DOWN &&
-                    !grid.isInCountdown() &&
-                    e.button.button == SDL_BUTTON_LEFT) {
-                    grid.handleClick(camYaw, camPitch);
+                else if (pointInRect(mx, my, menu.btns[MainMenu::BTN_CRED])) {
+                    state = CRED;
+                    SDL_SetWindowRelativeMouseMode(window, false);
                 }
-                else if (e.type == SDL_EVENT_KEY_DOWN &&
-                    e.key.key == SDLK_ESCAPE) {
+            }
+        }
+        else if (state == SETT) {
+            if (in.type == SDL_EVENT_MOUSE_MOTION)
+                settings.handleMouseMove(mx, my);
+            else if (in.type == SDL_EVENT_MOUSE_BUTTON_DOWN)
+                settings.handleMouseDown(mx, my);
+            else if (in.type == SDL_EVENT_MOUSE_BUTTON_UP) {
+                settings.handleMouseUp();
+                if (pointInRect(mx, my, settings.applyBtn)) {
+                    settings.apply();
+                    pacer.apply(renderer, config.pacingMode, config.fpsCap);
+                    sim.setView(liveContext.proj);   // the FOV may have changed
                     state = MAIN;
-                    SDL_SetWindowRelativeMouseMode(window, false);
                 }
+                else if (pointInRect(mx, my, settings.resetBtn)) {
+                    settings.reset();
+                }
+            }
+        }
+        else if (state == STATS) {
+            if (in.type == SDL_EVENT_MOUSE_MOTION)
+                stats.handleMouseMove(mx, my);
+            else if (in.type == SDL_EVENT_MOUSE_BUTTON_DOWN && stats.handleMouseDown(mx, my))
+                state = MAIN;
+        }
+        else if (state == DRILL) {
+            bool back = false;
+            if (in.type == SDL_EVENT_MOUSE_MOTION)
+                drillMenu.handleMouseMove(mx, my);
+            else if (in.type == SDL_EVENT_MOUSE_BUTTON_DOWN) {
+                if (const Scenario* drill = drillMenu.handleMouseDown(mx, my, back))
+                    startSession(*drill);
+                else if (back) state = MAIN;
             }
-            else if (state == TRACK) {
-                if (e.type == SDL_EVENT_MOUSE_MOTION &&
-                    !track.isInCountdown()) {
-                    camYaw += e.motion.xrel * config.sensitivity;
-                    camPitch -= e.motion.yrel * config.sensitivity;
-                    camPitch = CLAMP(camPitch, -89.0, 89.0);
-                    if (camYaw < 0) camYaw += 360; if (camYaw >= 360) camYaw -= 360;
+        }
+        else if (state == CRED) {
+            if (in.type == SDL_EVENT_MOUSE_BUTTON_DOWN)
+                state = MAIN;
+        }
+    };
+    auto finishSession = [&](SessionMode sm, const GameMode& mode, double score) {
+        if (simClock.droppedTicks)
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,
+                "Session ran %llu ticks short",
+                (unsigned long long)simClock.droppedTicks);
+        if (Uint32 lost = inputRing.dropped.exchange(0))
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,
+                "Input ring overflowed, %u mouse events lost", lost);
+        if (soakSkill) {
+            recorder.finish(score, false);
+            std::vector<Uint8> buf;
+            Replay::Recording copy;
+            Replay::encode(recorder.last(), buf);
+            double replayed = Replay::decode(buf, copy) ? soakReplay.play(copy) : NAN;
+            if (replayed != score) {
+                ++soakMismatched;
+                SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Soak: %s scored %.3f live, %.3f replayed",
+                    mode.scenario.name, score, replayed);
+            }
+            soakScores[(soakNext - 1) % soakDrills.size()].push_back(score);
+        }
+        else {
+            ScoreLog::Record rec = ScoreLog::make(sm, mode.isChallengeMode(), score, mode.scenario.id);
+            scoreLog.add(rec);
+            persist.appendScore(rec);
+            recorder.finish(score);
+            Telemetry::save(shotLog, sm, mode);
+        }
+        state = MAIN;
+        SDL_SetWindowRelativeMouseMode(window, false);
+    };
+
+    while (!quit) {
+        FrameTiming ft{};
+        Uint64 frameStart = SDL_GetTicksNS();
+        TRACE_SCOPE("frame", Trace::frame());
+        SDL_Event e;
+        while (SDL_PollEvent(&e)) {
+            if (e.type == SDL_EVENT_QUIT) quit = true;
+            else if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F3)
+                perf.visible = !perf.visible;
+            else if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F11) {
+                config.fullscreen = !config.fullscreen;
+                SDL_SetWindowFullscreen(window, config.fullscreen);
+                persist.saveConfig(config);
+            }
+            else if (e.type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED ||
+                e.type == SDL_EVENT_WINDOW_DISPLAY_SCALE_CHANGED) {
+                if (syncView(window, renderer)) {
+                    menu.layout();
+                    settings.layout();
+                    stats.layout();
+                    drillMenu.layout();
+                    sim.setView(liveContext.proj);
                 }
-                else if (e.type == SDL_EVENT_KEY_DOWN &&
-                    e.key.key == SDLK_ESCAPE) {
+            }
+            else if (e.type == SDL_EVENT_RENDER_TARGETS_RESET ||
+                e.type == SDL_EVENT_RENDER_DEVICE_RESET) {
+                textCache.clear();
+                governor.release();
+            }
+            else if (e.type == SDL_EVENT_WINDOW_DISPLAY_CHANGED)
+                pacer.apply(renderer, config.pacingMode, config.fpsCap);   // new refresh rate
+            else if (e.type != SDL_EVENT_KEY_DOWN) {
+                // mouse input is consumed from inputRing below
+            }
+            else if (state == MAIN) {
+                if (e.key.key == SDLK_ESCAPE) quit = true;
+            }
+            else if (state == GRID || state == TRACK || state == SWARM) {
+                if (e.key.key == SDLK_ESCAPE) {
+                    sim.stop();
                     state = MAIN;
                     SDL_SetWindowRelativeMouseMode(window, false);
                 }
             }
             else if (state == SETT) {
-                if (e.type == SDL_EVENT_MOUSE_MOTION)
-                    settings.handleMouseMove(e.motion.x, e.motion.y);
-                else if (e.type == SDL_EVENT_MOUSE_BUTTON_DOWN)
-                    settings.handleMouseDown(e.button.x, e.button.y);
-                else if (e.type == SDL_EVENT_MOUSE_BUTTON_UP) {
-                    settings.handleMouseUp();
-                    int mx = e.button.x, my = e.button.y;
-                    if (pointInRect(mx, my, settings.applyBtn)) {
-                        settings.apply();
-                        state = MAIN;
-                    }
-                    else if (pointInRect(mx, my, settings.resetBtn)) {
-                        settings.reset();
-                    }
-                }
-                else if (e.type == SDL_EVENT_KEY_DOWN &&
-                    e.key.key == SDLK_ESCAPE) {
+                if (e.key.key == SDLK_ESCAPE) {
                     settings.reset();
                     state = MAIN;
                 }
             }
-            else if (state == CRED) {
-                if (e.type == SDL_EVENT_MOUSE_BUTTON_DOWN ||
-                    e.type == SDL_EVENT_KEY_DOWN) {
-                    state = MAIN;
+            else if (state == STATS) {
+                if (e.key.key == SDLK_ESCAPE) state = MAIN;
+                else if (e.key.key == SDLK_LEFT) stats.cycleMode(-1);
+                else if (e.key.key == SDLK_RIGHT) stats.cycleMode(1);
+            }
+            else if (state == DRILL) {
+                if (e.key.key == SDLK_ESCAPE) state = MAIN;
+                else if (e.key.key == SDLK_LEFT) drillMenu.cyclePage(-1);
+                else if (e.key.key == SDLK_RIGHT) drillMenu.cyclePage(1);
+                else if (e.key.key == SDLK_F5) {
+                    library.load();
+                    drillMenu.setDrills(library.drills);
                 }
             }
-        }
-        if (state == GRID && grid.isRunning()) {
-            grid.update(delta, camYaw, camPitch);
-            if (!grid.isRunning()) {
-                config.gridshotScores.push_back(grid.getScore());
-                JSONStorage::saveConfig(config);
+            else if (state == CRED) {
                 state = MAIN;
-                SDL_SetWindowRelativeMouseMode(window, false);
             }
         }
-        else if (state == TRACK && track.isRunning()) {
-            track.update(delta, camYaw, camPitch);
-            if (!track.isRunning()) {
-                config.trackingScores.push_back(track.getScore());
-                JSONStorage::saveConfig(config);
-                state = MAIN;
-                SDL_SetWindowRelativeMouseMode(window, false);
-            }
+        Uint64 nowNS = SDL_GetTicksNS();
+        ft.events = nowNS - frameStart;
+        Trace::span("events", frameStart, nowNS);
+        if (soakSkill && state == MAIN) {
+            if (nowNS >= soakEnd) quit = true;
+            else startSession(soakDrills[soakNext++ % soakDrills.size()]);
+        }
+        // menus take everything queued so far; a session started here
+        // leaves the rest to the simulation thread
+        InputEvent in;
+        while (!(state == GRID || state == TRACK || state == SWARM) && inputRing.peek(in)) {
+            inputRing.pop();
+            dispatchMouse(in);
+            Trace::consumed(in.timeNS);
         }
+        sim.pump();
+        if ((state == GRID || state == TRACK || state == SWARM) && sim.over()) {
+            sim.stop();
+            double score = session == MODE_GRIDSHOT ? grid.getScore()
+                : session == MODE_TRACKING ? track.getScore() : swarm.getScore();
+            finishSession(session, *modes[session], score);
+        }
+        const Snapshot& snap = sim.snapshots.latest();
+        // the input events whose effect this frame shows (tracing)
+        Uint64 shown = state == GRID || state == TRACK || state == SWARM ? snap.inputs : Trace::consumedCount();
+        Uint64 phase = SDL_GetTicksNS();
+        ft.update = phase - nowNS;
         switch (state) {
         case MAIN:  menu.render(renderer); break;
-        case GRID:  grid.render(renderer, camYaw, camPitch); break;
-        case TRACK: track.render(renderer, camYaw, camPitch); break;
+        case GRID:  grid.render(renderer, snap, snap.blend(phase)); break;
+        case TRACK: track.render(renderer, snap, snap.blend(phase)); break;
+        case SWARM: swarm.render(renderer, snap, snap.blend(phase)); break;
         case SETT:  settings.render(renderer); break;
+        case STATS: stats.render(renderer); break;
         case CRED:  credits.render(renderer); break;
+        case DRILL: drillMenu.render(renderer); break;
+        }
+        perf.render(renderer);
+        batch.endFrame();
+        textCache.endFrame();
+        // run the queued drawing here so present only holds the swap and
+        // any vsync wait, and the governor sees the real render cost
+        {
+            TRACE_SCOPE("flush");
+            SDL_FlushRenderer(renderer);
         }
+        ft.drawCalls = batch.lastDrawCalls;
+        ft.primitives = batch.lastPrimitives;
+        ft.sceneScale = governor.scale;
+        Uint64 presentStart = SDL_GetTicksNS();
+        ft.render = presentStart - phase;
         SDL_RenderPresent(renderer);
-        SDL_Delay(1);
+        Uint64 presentEnd = SDL_GetTicksNS();
+        ft.present = presentEnd - presentStart;
+        Trace::span("present", presentStart, presentEnd, Trace::frame());
+        Trace::endFrame(shown);
+        governor.update(ft.events + ft.update + ft.render + (pacer.vsync() ? 0 : ft.present),
+            pacer.budgetNS());
+        {
+            TRACE_SCOPE("pace");
+            pacer.wait(!(state == GRID || state == TRACK || state == SWARM));
+        }
+        ft.total = SDL_GetTicksNS() - frameStart;
+        perf.push(ft);
+    }
+    sim.shutdown();
+    SDL_RemoveEventWatch(captureMouseEvent, &inputRing);
+    size_t soakSessions = 0;
+    for (size_t i = 0; i < soakScores.size(); ++i) {
+        char label[64];
+        snprintf(label, sizeof(label), "%s/%s", soakDrills[i].name, soakSkill->name);
+        SimPlayer::printScores(label, soakScores[i]);
+        soakSessions += soakScores[i].size();
     }
+    if (soakSkill)
+        printf("soak: %zu sessions, %d replay mismatches\n", soakSessions, soakMismatched);
+    persist.stop();
+    Trace::save(TRACE_FILE);
+    textCache.clear();
+    governor.release();
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
-    return 0;
+    return soakMismatched ? 1 : 0;
 }